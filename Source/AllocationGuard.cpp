@@ -0,0 +1,127 @@
+#include "AllocationGuard.h"
+
+#if UTILITY_ALLOCATION_GUARD
+
+#include <new>
+#include <cstdlib>
+
+#if JUCE_WINDOWS
+ #include <malloc.h>
+#endif
+
+namespace
+{
+    thread_local int guardDepth = 0;
+    std::atomic<int> numGuardedAllocations{ 0 };
+
+    void checkGuard()
+    {
+        if (guardDepth > 0)
+        {
+            ++numGuardedAllocations;
+
+            // The assertion handler may allocate itself, so drop the guard while it runs
+            const auto depth = std::exchange(guardDepth, 0);
+            jassertfalse; // heap allocation on the audio thread
+            guardDepth = depth;
+        }
+    }
+
+    void* allocate(std::size_t size)
+    {
+        checkGuard();
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    // For over-aligned types. std::aligned_alloc isn't available with MSVC,
+    // whose aligned blocks must also be freed with _aligned_free.
+    void* allocateAligned(std::size_t size, std::align_val_t alignment)
+    {
+        checkGuard();
+
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size == 0 ? 1 : size, (std::size_t)alignment);
+       #else
+        void* ptr = nullptr;
+        return posix_memalign(&ptr, juce::jmax(sizeof(void*), (std::size_t)alignment), size == 0 ? 1 : size) == 0 ? ptr : nullptr;
+       #endif
+    }
+
+    void freeAligned(void* ptr)
+    {
+       #if JUCE_WINDOWS
+        _aligned_free(ptr);
+       #else
+        std::free(ptr);
+       #endif
+    }
+}
+
+ScopedAllocationGuard::ScopedAllocationGuard()
+{
+    ++guardDepth;
+}
+
+ScopedAllocationGuard::~ScopedAllocationGuard()
+{
+    --guardDepth;
+}
+
+int ScopedAllocationGuard::getNumGuardedAllocations()
+{
+    return numGuardedAllocations.load();
+}
+
+void* operator new (std::size_t size)
+{
+    if (auto* ptr = allocate(size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    if (auto* ptr = allocate(size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete (void* ptr) noexcept { std::free(ptr); }
+void operator delete[] (void* ptr) noexcept { std::free(ptr); }
+void operator delete (void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[] (void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete (void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[] (void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void* operator new (std::size_t size, std::align_val_t alignment)
+{
+    if (auto* ptr = allocateAligned(size, alignment))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size, std::align_val_t alignment)
+{
+    if (auto* ptr = allocateAligned(size, alignment))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+
+void operator delete (void* ptr, std::align_val_t) noexcept { freeAligned(ptr); }
+void operator delete[] (void* ptr, std::align_val_t) noexcept { freeAligned(ptr); }
+void operator delete (void* ptr, std::size_t, std::align_val_t) noexcept { freeAligned(ptr); }
+void operator delete[] (void* ptr, std::size_t, std::align_val_t) noexcept { freeAligned(ptr); }
+void operator delete (void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(ptr); }
+void operator delete[] (void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(ptr); }
+
+#endif
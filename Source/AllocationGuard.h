@@ -0,0 +1,27 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Debug builds replace the global operator new/delete so that any heap
+// allocation made while a ScopedAllocationGuard is alive on the current thread
+// triggers an assertion. Put one at the top of processBlock.
+#ifndef UTILITY_ALLOCATION_GUARD
+ #define UTILITY_ALLOCATION_GUARD JUCE_DEBUG
+#endif
+
+struct ScopedAllocationGuard
+{
+#if UTILITY_ALLOCATION_GUARD
+    ScopedAllocationGuard();
+    ~ScopedAllocationGuard();
+
+    // Number of allocations made inside a guarded scope, on any thread, since startup
+    static int getNumGuardedAllocations();
+#else
+    ScopedAllocationGuard() {}
+
+    static int getNumGuardedAllocations() { return 0; }
+#endif
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedAllocationGuard)
+};
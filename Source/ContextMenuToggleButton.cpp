@@ -0,0 +1,20 @@
+#include "ContextMenuToggleButton.h"
+
+void ContextMenuToggleButton::mouseDown(const juce::MouseEvent& e)
+{
+    if (e.mods.isRightButtonDown() && rightClickCallback)
+    {
+        rightClickCallback(e);
+    }
+    else
+    {
+        juce::ToggleButton::mouseDown(e);
+    }
+}
+
+void ContextMenuToggleButton::mouseUp(const juce::MouseEvent& e)
+{
+    // A right click opens the menu, it doesn't toggle the button
+    if (!(e.mods.isRightButtonDown() && rightClickCallback))
+        juce::ToggleButton::mouseUp(e);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+
+class ContextMenuToggleButton : public juce::ToggleButton
+{
+public:
+    ContextMenuToggleButton(const std::function<void(const juce::MouseEvent&)>& onRightClickCallback) : rightClickCallback(onRightClickCallback) {}
+
+    void mouseDown(const juce::MouseEvent& e) override;
+    void mouseUp(const juce::MouseEvent& e) override;
+
+private:
+    std::function<void(const juce::MouseEvent&)> rightClickCallback;
+};
@@ -0,0 +1,67 @@
+#include "CrossoverSpectrum.h"
+
+
+CrossoverSpectrum::CrossoverSpectrum(Metering& metering, juce::Slider& crossoverSlider, juce::NormalisableRange<float> crossoverRange)
+    : slider(crossoverSlider),
+      frequencies(getBandFrequencies(crossoverRange)),
+      analyser(metering, frequencies)
+{
+    setName("Crossover Spectrum");
+    setInterceptsMouseClicks(false, false);
+
+    spectrum.mid.assign(frequencies.size(), SpectrumAnalyser::minDecibels);
+    spectrum.side.assign(frequencies.size(), SpectrumAnalyser::minDecibels);
+
+    startTimerHz(refreshRate);
+}
+
+std::vector<float> CrossoverSpectrum::getBandFrequencies(juce::NormalisableRange<float> range)
+{
+    // Evenly spaced along the slider, whatever its skew
+    std::vector<float> bandFrequencies((size_t)numBands);
+
+    for (int band = 0; band < numBands; ++band)
+        bandFrequencies[(size_t)band] = range.convertFrom0to1((float)band / (float)(numBands - 1));
+
+    return bandFrequencies;
+}
+
+void CrossoverSpectrum::timerCallback()
+{
+    // The crossover line follows the slider while no audio is playing too
+    if (analyser.getLatest(spectrum) || slider.getValue() != paintedCrossover)
+        repaint();
+}
+
+void CrossoverSpectrum::paint(juce::Graphics& g)
+{
+    const auto height = (float)getHeight();
+
+    auto makePath = [&](const std::vector<float>& levels)
+    {
+        juce::Path path;
+        path.startNewSubPath((float)slider.getPositionOfValue(frequencies.front()), height);
+
+        for (size_t band = 0; band < frequencies.size(); ++band)
+        {
+            const auto x = (float)slider.getPositionOfValue(frequencies[band]);
+            const auto y = juce::jmap(levels[band], SpectrumAnalyser::minDecibels, 0.f, height, 0.f);
+            path.lineTo(x, juce::jlimit(0.f, height, y));
+        }
+
+        path.lineTo((float)slider.getPositionOfValue(frequencies.back()), height);
+        path.closeSubPath();
+        return path;
+    };
+
+    g.setColour(juce::Colours::grey.withAlpha(0.3f));
+    g.fillPath(makePath(spectrum.mid));
+
+    // Side energy below the crossover is what bass mono removes
+    g.setColour(juce::Colours::black.withAlpha(0.35f));
+    g.fillPath(makePath(spectrum.side));
+
+    paintedCrossover = slider.getValue();
+    g.setColour(juce::Colours::darkgrey);
+    g.drawVerticalLine(juce::roundToInt(slider.getPositionOfValue(paintedCrossover)), 0.f, height);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyser.h"
+
+
+// Mid and side spectra over the bass crossover range, drawn behind the
+// crossover slider with its frequency axis, so the thumb sits on the spectrum
+// at the crossover frequency.
+class CrossoverSpectrum : public juce::Component, private juce::Timer
+{
+public:
+    CrossoverSpectrum(Metering& metering, juce::Slider& crossoverSlider, juce::NormalisableRange<float> crossoverRange);
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    void timerCallback() override;
+
+    static std::vector<float> getBandFrequencies(juce::NormalisableRange<float> range);
+
+    static constexpr int numBands = 96;
+    static constexpr int refreshRate = 30;
+
+    juce::Slider& slider;
+    const std::vector<float> frequencies;
+    SpectrumAnalyser analyser;
+    SpectrumAnalyser::Spectrum spectrum;
+    double paintedCrossover = 0.0;
+};
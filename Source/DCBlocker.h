@@ -0,0 +1,137 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+
+// High-pass for removing DC from a stereo pair, first or second order
+// (Butterworth). Both channels run through the same loop with their state
+// side by side, so the compiler keeps them in the two lanes of one vector
+// register instead of running the filter once per channel.
+//
+// The second order is a TPT state variable filter: unlike a direct form biquad
+// it stays accurate with cutoffs of a few Hz, even in single precision at high
+// sample rates.
+template <typename SampleType>
+class DCBlocker
+{
+public:
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        cutoff = 0;
+        reset();
+    }
+
+    void reset()
+    {
+        state1.fill(0);
+        state2.fill(0);
+    }
+
+    // Recomputes the coefficients only when something changed
+    void setParameters(SampleType newCutoff, int newOrder)
+    {
+        if (newOrder != order)
+        {
+            order = newOrder;
+            reset();
+        }
+
+        if (newCutoff == cutoff)
+            return;
+
+        cutoff = newCutoff;
+        g = (SampleType)std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate);
+        h = 1 / (1 + R2 * g + g * g);
+        firstOrderGain = 1 / (1 + g);
+        firstOrderFeedback = (1 - g) / (1 + g);
+    }
+
+    void process(SampleType* left, SampleType* right, int numSamples)
+    {
+        SampleType* channels[] = { left, right };
+
+        if (order == 1)
+            processFirstOrder<2>(channels, numSamples);
+        else
+            processSecondOrder<2>(channels, numSamples);
+    }
+
+    // A single channel uses the state of the left one
+    void process(SampleType* channel, int numSamples)
+    {
+        SampleType* channels[] = { channel };
+
+        if (order == 1)
+            processFirstOrder<1>(channels, numSamples);
+        else
+            processSecondOrder<1>(channels, numSamples);
+    }
+
+private:
+    static constexpr auto R2 = juce::MathConstants<SampleType>::sqrt2;
+
+    // Bilinear one pole high-pass. Its state is the last input and the (small)
+    // last output, a low-pass state near the DC level would stop converging in
+    // single precision once the steps fall below its resolution.
+    template <int numLanes>
+    void processFirstOrder(SampleType* const* channels, int numSamples)
+    {
+        auto lastInput = state1;
+        auto lastOutput = state2;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                const auto x = channels[lane][sample];
+                const auto y = firstOrderGain * (x - lastInput[(size_t)lane]) + firstOrderFeedback * lastOutput[(size_t)lane];
+                lastInput[(size_t)lane] = x;
+                lastOutput[(size_t)lane] = y;
+                channels[lane][sample] = y;
+            }
+        }
+
+        for (auto& value : lastOutput)
+            juce::dsp::util::snapToZero(value);
+
+        state1 = lastInput;
+        state2 = lastOutput;
+    }
+
+    template <int numLanes>
+    void processSecondOrder(SampleType* const* channels, int numSamples)
+    {
+        auto s1 = state1;
+        auto s2 = state2;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                const auto x = channels[lane][sample];
+                const auto high = (x - (R2 + g) * s1[(size_t)lane] - s2[(size_t)lane]) * h;
+                const auto band = g * high + s1[(size_t)lane];
+                s1[(size_t)lane] = g * high + band;
+                const auto low = g * band + s2[(size_t)lane];
+                s2[(size_t)lane] = g * band + low;
+                channels[lane][sample] = high;
+            }
+        }
+
+        for (auto* state : { &s1, &s2 })
+            for (auto& value : *state)
+                juce::dsp::util::snapToZero(value);
+
+        state1 = s1;
+        state2 = s2;
+    }
+
+    double sampleRate = 44100.0;
+    SampleType cutoff = 0;
+    int order = 2;
+    SampleType g = 0, h = 0;
+    SampleType firstOrderGain = 0, firstOrderFeedback = 0;
+
+    std::array<SampleType, 2> state1{}, state2{};
+};
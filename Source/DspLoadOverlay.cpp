@@ -0,0 +1,151 @@
+#include "DspLoadOverlay.h"
+#include "Font.h"
+
+#if UTILITY_ENABLE_PROFILING
+
+DspLoadOverlay::DspLoadOverlay(DspProfiler& profilerToShow)
+    : profiler(profilerToShow)
+{
+    setName("DSP Load Overlay");
+    setInterceptsMouseClicks(false, false);
+}
+
+void DspLoadOverlay::visibilityChanged()
+{
+    if (isVisible())
+    {
+        lastStageTimes = profiler.getStageTimes();
+        stageShares.fill(0);
+        timerCallback();
+        startTimerHz(refreshRate);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void DspLoadOverlay::timerCallback()
+{
+    load = profiler.getLoadPercent();
+    numOverruns = profiler.getNumOverruns();
+    histogram = profiler.getHistogram();
+
+    const auto stageTimes = profiler.getStageTimes();
+    const auto blockTicks = stageTimes.blockTicks - lastStageTimes.blockTicks;
+
+    // Nothing new while the host isn't processing, or between timed blocks
+    if (blockTicks > 0)
+    {
+        const auto averaging = 1.0 - std::exp(-1.0 / (refreshRate * averagingSeconds));
+
+        for (size_t stage = 0; stage < stageShares.size(); ++stage)
+        {
+            const auto share = (double)(stageTimes.stageTicks[stage] - lastStageTimes.stageTicks[stage]) / (double)blockTicks;
+            stageShares[stage] += averaging * (share - stageShares[stage]);
+        }
+
+        lastStageTimes = stageTimes;
+    }
+
+    repaint();
+}
+
+juce::String DspLoadOverlay::formatPercent(double percent)
+{
+    return juce::String(percent, percent < 10.0 ? 2 : 1) + " %";
+}
+
+//==============================================================================
+void DspLoadOverlay::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black.withAlpha(0.75f));
+
+    auto area = getLocalBounds().toFloat().reduced(8.f, 5.f);
+    const auto lineHeight = 14.f;
+
+    g.setColour(numOverruns > 0 ? juce::Colours::orange : juce::Colours::white);
+    g.setFont(Fonts::getRegular(FontHeight::S).withHeight(lineHeight - 1.f));
+    g.drawText("DSP " + formatPercent(load) + "   p99 " + formatPercent(histogram.getPercentile(99.0))
+                   + "   overruns " + juce::String(numOverruns),
+               area.removeFromTop(lineHeight), juce::Justification::centredLeft);
+    area.removeFromTop(4.f);
+
+    const auto halfWidth = (area.getWidth() - 10.f) / 2.f;
+    drawHistogram(g, area.removeFromLeft(halfWidth));
+    drawStages(g, area.removeFromRight(halfWidth));
+}
+
+void DspLoadOverlay::drawHistogram(juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    // Percent of the block's duration on a log axis, the budget on the right
+    constexpr auto numBins = DspProfiler::LoadHistogram::numBins;
+    const auto labelArea = area.removeFromBottom(12.f);
+
+    g.setColour(juce::Colours::grey.withAlpha(0.3f));
+    g.fillRect(area);
+
+    juce::uint32 maximum = 0;
+
+    for (auto count : histogram.counts)
+        maximum = juce::jmax(maximum, count);
+
+    const auto binWidth = area.getWidth() / (float)numBins;
+
+    if (maximum > 0)
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            // Square root, so rare slow blocks still show next to the bulk of them
+            const auto count = histogram.counts[(size_t)bin];
+            const auto height = area.getHeight() * std::sqrt((float)count / (float)maximum);
+
+            g.setColour(DspProfiler::LoadHistogram::getUpperEdge(bin) > 100.0 ? juce::Colours::red : juce::Colours::lightgrey);
+            g.fillRect(area.getX() + (float)bin * binWidth, area.getBottom() - height, juce::jmax(1.f, binWidth - 1.f), height);
+        }
+    }
+
+    g.setColour(juce::Colours::grey);
+    g.setFont(Fonts::getRegular(FontHeight::S).withHeight(10.f));
+
+    for (auto percent : { 0.1, 1.0, 10.0, 100.0 })
+    {
+        const auto bins = std::log2(percent / DspProfiler::LoadHistogram::lowestPercent) * DspProfiler::LoadHistogram::binsPerOctave;
+        const auto x = area.getX() + (float)bins * binWidth;
+        g.drawVerticalLine(juce::roundToInt(x), area.getY(), area.getBottom());
+        g.drawText(juce::String(percent, percent < 1.0 ? 1 : 0) + "%", juce::Rectangle<float>(x - 15.f, labelArea.getY(), 30.f, labelArea.getHeight()),
+                   juce::Justification::centred);
+    }
+}
+
+void DspLoadOverlay::drawStages(juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    // Stage shares of the timed blocks, applied to the load of the others
+    constexpr auto numRows = DspProfiler::numStages + 1;
+    const auto rowHeight = area.getHeight() / (float)numRows;
+    const auto textWidth = area.getWidth() * 0.55f;
+
+    auto other = 1.0;
+    g.setFont(Fonts::getRegular(FontHeight::S).withHeight(juce::jmin(rowHeight - 1.f, 11.f)));
+
+    for (int row = 0; row < numRows; ++row)
+    {
+        const auto isOther = row == DspProfiler::numStages;
+        const auto share = isOther ? juce::jmax(0.0, other) : stageShares[(size_t)row];
+        other -= share;
+
+        auto line = area.removeFromTop(rowHeight);
+        const auto bar = line.removeFromRight(area.getWidth() - textWidth).reduced(0.f, 2.f);
+
+        g.setColour(juce::Colours::white);
+        g.drawText((isOther ? juce::String("Other") : DspProfiler::getStageName(row)) + " " + formatPercent(share * load),
+                   line, juce::Justification::centredLeft);
+
+        g.setColour(juce::Colours::grey.withAlpha(0.3f));
+        g.fillRect(bar);
+        g.setColour(juce::Colours::lightgrey);
+        g.fillRect(bar.withWidth(bar.getWidth() * (float)juce::jlimit(0.0, 1.0, share)));
+    }
+}
+
+#endif
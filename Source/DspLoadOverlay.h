@@ -0,0 +1,44 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "DspProfiler.h"
+
+#if UTILITY_ENABLE_PROFILING
+
+// This instance's processing load, drawn over the goniometer: the load
+// against the real-time budget, overruns, a histogram of the loads of recent
+// blocks and what each stage of the chain takes. Polls the processor's
+// DspProfiler from a timer while it is shown, and lets clicks through to the
+// components underneath.
+class DspLoadOverlay : public juce::Component, private juce::Timer
+{
+public:
+    explicit DspLoadOverlay(DspProfiler& profiler);
+
+    void paint(juce::Graphics& g) override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+
+    void drawHistogram(juce::Graphics& g, juce::Rectangle<float> area) const;
+    void drawStages(juce::Graphics& g, juce::Rectangle<float> area) const;
+
+    static juce::String formatPercent(double percent);
+
+    static constexpr int refreshRate = 10;
+    // Stage shares average over about this long, the stages are only timed now and then
+    static constexpr double averagingSeconds = 1.0;
+
+    DspProfiler& profiler;
+
+    double load = 0;
+    int numOverruns = 0;
+    DspProfiler::LoadHistogram histogram;
+
+    DspProfiler::StageTimes lastStageTimes;
+    // Of the time of the timed blocks, the rest is spent outside the stages
+    std::array<double, DspProfiler::numStages> stageShares{};
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "DspProfiler.h"
+
+#if UTILITY_ENABLE_PROFILING
+
+juce::String DspProfiler::getStageName(int stage)
+{
+    switch (stage)
+    {
+        case matrixStage:   return "Matrix";
+        case bassMonoStage: return "Bass Mono";
+        case gainStage:     return "Gain/Balance";
+        case dcStage:       return "DC";
+        case meteringStage: return "Meters";
+        default:            return {};
+    }
+}
+
+void DspProfiler::prepare(double newSampleRate, int maximumBlockSize)
+{
+    // Hosts prepare again whenever playback restarts, the overruns are kept
+    overrunsBeforeReset.store(getNumOverruns(), std::memory_order_relaxed);
+    loadMeasurer.reset(newSampleRate, maximumBlockSize);
+
+    sampleRate = newSampleRate;
+    blocksUntilStageTiming = 0;
+}
+
+void DspProfiler::beginBlock()
+{
+    timingStages = --blocksUntilStageTiming < 0;
+
+    if (timingStages)
+    {
+        blocksUntilStageTiming = stageTimingInterval - 1;
+        blockStageTicks.fill(0);
+    }
+
+    blockStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+void DspProfiler::endBlock(int numSamples)
+{
+    const auto ticks = juce::Time::getHighResolutionTicks() - blockStartTicks;
+
+    if (numSamples <= 0 || sampleRate <= 0)
+        return;
+
+    if (timingStages)
+    {
+        for (size_t stage = 0; stage < (size_t)numStages; ++stage)
+            stageTotals[stage].store(stageTotals[stage].load(std::memory_order_relaxed) + blockStageTicks[stage], std::memory_order_relaxed);
+
+        timedBlockTotal.store(timedBlockTotal.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+        timingStages = false;
+        return;
+    }
+
+    const auto seconds = (double)ticks * secondsPerTick;
+    loadMeasurer.registerRenderTime(seconds * 1000.0, numSamples);
+
+    samplesInGeneration += numSamples;
+    auto generation = currentGeneration.load(std::memory_order_relaxed);
+
+    if ((double)samplesInGeneration >= historySeconds * sampleRate)
+    {
+        generation = 1 - generation;
+
+        for (auto& count : generations[(size_t)generation])
+            count.store(0, std::memory_order_relaxed);
+
+        currentGeneration.store(generation, std::memory_order_relaxed);
+        samplesInGeneration = 0;
+    }
+
+    const auto percent = seconds * sampleRate / (double)numSamples * 100.0;
+    auto& count = generations[(size_t)generation][(size_t)LoadHistogram::getBin(percent)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+DspProfiler::LoadHistogram DspProfiler::getHistogram() const
+{
+    LoadHistogram histogram;
+
+    for (const auto& counts : generations)
+        for (size_t bin = 0; bin < counts.size(); ++bin)
+            histogram.counts[bin] += counts[bin].load(std::memory_order_relaxed);
+
+    return histogram;
+}
+
+DspProfiler::StageTimes DspProfiler::getStageTimes() const
+{
+    StageTimes times;
+
+    for (size_t stage = 0; stage < (size_t)numStages; ++stage)
+        times.stageTicks[stage] = stageTotals[stage].load(std::memory_order_relaxed);
+
+    times.blockTicks = timedBlockTotal.load(std::memory_order_relaxed);
+    return times;
+}
+
+//==============================================================================
+int DspProfiler::LoadHistogram::getBin(double percent)
+{
+    if (percent <= lowestPercent)
+        return 0;
+
+    return juce::jmin(numBins - 1, (int)(std::log2(percent / lowestPercent) * binsPerOctave));
+}
+
+juce::int64 DspProfiler::LoadHistogram::getTotal() const
+{
+    return std::accumulate(counts.begin(), counts.end(), (juce::int64)0);
+}
+
+double DspProfiler::LoadHistogram::getPercentile(double percent) const
+{
+    const auto total = getTotal();
+
+    if (total == 0)
+        return 0;
+
+    const auto target = (double)total * percent * 0.01;
+    juce::int64 below = 0;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        below += counts[(size_t)bin];
+
+        if ((double)below >= target && below > 0)
+            return getUpperEdge(bin);
+    }
+
+    return getUpperEdge(numBins - 1);
+}
+
+#endif
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Measures the processor's own processing time and shows it in the editor.
+// Like the allocation guard it is on in debug builds; define it as 1 for a
+// release build to profile optimised code. When 0 nothing of it is compiled.
+#ifndef UTILITY_ENABLE_PROFILING
+ #define UTILITY_ENABLE_PROFILING JUCE_DEBUG
+#endif
+
+#if UTILITY_ENABLE_PROFILING
+
+// Time spent in processBlock() against the real-time budget of each block,
+// i.e. the block's duration, and how it splits up between the stages of the
+// chain. Written by the audio thread, read by the editor without locks.
+//
+// Every block is timed as a whole, which costs two clock reads. The stages
+// are timed in only one of every stageTimingInterval blocks: the clock reads
+// around each stage of each tile would otherwise cost about as much as the
+// cheaper stages themselves. Those blocks are left out of the load, so the
+// load is that of the plugin without the profiler's stage timers.
+class DspProfiler
+{
+public:
+    // Polarity, mode, width / mid-side and mono are folded into one matrix,
+    // so they are timed together. Without bass mono, gain and balance are
+    // folded into that matrix too.
+    enum Stage
+    {
+        matrixStage,
+        bassMonoStage,
+        gainStage,          // gain and balance
+        dcStage,
+        meteringStage,      // meters and loudness
+        numStages
+    };
+
+    static juce::String getStageName(int stage);
+
+    // From prepareToPlay()
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    // Audio thread, around all the work of a host block
+    void beginBlock();
+    void endBlock(int numSamples);
+
+    // Adds the time until it goes out of scope to a stage, if this block's
+    // stages are timed. A null profiler is fine.
+    class ScopedStage
+    {
+    public:
+        ScopedStage(DspProfiler* profilerToUse, Stage stageToTime) noexcept
+            : profiler(profilerToUse != nullptr && profilerToUse->timingStages ? profilerToUse : nullptr),
+              stage(stageToTime),
+              startTicks(profiler != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~ScopedStage()
+        {
+            if (profiler != nullptr)
+                profiler->blockStageTicks[(size_t)stage] += juce::Time::getHighResolutionTicks() - startTicks;
+        }
+
+    private:
+        DspProfiler* const profiler;
+        const Stage stage;
+        const juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    };
+
+    // Loads of single blocks, in percent of their duration, over the last
+    // historySeconds to twice that: bins a quarter of an octave wide from
+    // 0.01 % up to about 650 %.
+    struct LoadHistogram
+    {
+        static constexpr int binsPerOctave = 4;
+        static constexpr int numBins = 16 * binsPerOctave;
+        static constexpr double lowestPercent = 0.01;
+
+        static int getBin(double percent);
+        static double getUpperEdge(int bin) { return lowestPercent * std::exp2((double)(bin + 1) / binsPerOctave); }
+
+        juce::int64 getTotal() const;
+        // Upper edge of the bin holding the percentile, 0 without any blocks
+        double getPercentile(double percent) const;
+
+        std::array<juce::uint32, numBins> counts{};
+    };
+
+    // Running totals of the timed blocks, the editor looks at the differences
+    struct StageTimes
+    {
+        std::array<juce::int64, numStages> stageTicks{};
+        juce::int64 blockTicks = 0;
+    };
+
+    // Message thread
+    double getLoadPercent() const { return loadMeasurer.getLoadAsPercentage(); }
+    // Blocks that took longer than their duration, since the plugin was created
+    int getNumOverruns() const { return overrunsBeforeReset.load(std::memory_order_relaxed) + loadMeasurer.getXRunCount(); }
+    LoadHistogram getHistogram() const;
+    StageTimes getStageTimes() const;
+
+    static constexpr int stageTimingInterval = 8;
+    static constexpr double historySeconds = 5.0;
+
+private:
+    juce::AudioProcessLoadMeasurer loadMeasurer;
+    std::atomic<int> overrunsBeforeReset{ 0 };
+
+    double sampleRate = 0;
+    double secondsPerTick = 1.0 / (double)juce::Time::getHighResolutionTicksPerSecond();
+    juce::int64 blockStartTicks = 0;
+    int blocksUntilStageTiming = 0;
+    bool timingStages = false;
+    std::array<juce::int64, numStages> blockStageTicks{};
+
+    std::array<std::atomic<juce::int64>, numStages> stageTotals{};
+    std::atomic<juce::int64> timedBlockTotal{ 0 };
+
+    // The histogram is rolling: blocks are counted in one of two generations,
+    // and once historySeconds of audio have gone by the other one is cleared
+    // and takes over. Readers add up both. Only the audio thread writes, so
+    // the counts are plain loads and stores rather than atomic increments.
+    using Counts = std::array<std::atomic<juce::uint32>, LoadHistogram::numBins>;
+    std::array<Counts, 2> generations{};
+    std::atomic<int> currentGeneration{ 0 };
+    juce::int64 samplesInGeneration = 0;
+};
+
+ #define UTILITY_PROFILE_STAGE(profiler, stage) \
+    const DspProfiler::ScopedStage JUCE_JOIN_MACRO(profiledStage, __LINE__)(profiler, DspProfiler::stage)
+#else
+ #define UTILITY_PROFILE_STAGE(profiler, stage)
+#endif
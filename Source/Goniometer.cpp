@@ -0,0 +1,82 @@
+#include "Goniometer.h"
+
+
+namespace
+{
+    const auto backgroundColour = juce::Colours::lightgrey;
+    const auto traceColour = juce::Colours::black;
+}
+
+Goniometer::Goniometer(Metering& m)
+    : metering(m),
+      points((size_t)Metering::scopeFifoSize)
+{
+    setName("Goniometer");
+    setOpaque(true);
+
+    // Anything left over from an earlier editor is stale
+    metering.readScopePoints(points.data(), (int)points.size());
+    metering.addViewer();
+
+    startTimerHz(refreshRate);
+}
+
+Goniometer::~Goniometer()
+{
+    metering.removeViewer();
+}
+
+void Goniometer::resized()
+{
+    const auto size = juce::jmin(getWidth(), getHeight());
+    // In memory: the points are written pixel by pixel on every refresh, which
+    // a GPU-backed image would have to read back and upload each time
+    trace = juce::Image(juce::Image::RGB, juce::jmax(1, size), juce::jmax(1, size), false, juce::SoftwareImageType());
+    juce::Graphics(trace).fillAll(backgroundColour);
+}
+
+void Goniometer::timerCallback()
+{
+    // Always drain, so the points of a hidden scope don't pile up
+    const auto numPoints = metering.readScopePoints(points.data(), (int)points.size());
+
+    if (!isShowing() || !trace.isValid())
+        return;
+
+    {
+        juce::Graphics g(trace);
+        g.setColour(backgroundColour.withAlpha(fadePerRefresh));
+        g.fillRect(trace.getBounds());
+    }
+
+    const auto radius = (float)(trace.getWidth() - 1) / 2.f;
+    // Read as well as written: the faded trace so far has to stay in the image
+    juce::Image::BitmapData pixels(trace, juce::Image::BitmapData::readWrite);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        // Left-only signals lean to the left, right-only ones to the right
+        const auto x = juce::roundToInt(radius * (1.f - points[(size_t)i].side));
+        const auto y = juce::roundToInt(radius * (1.f - points[(size_t)i].mid));
+
+        if (juce::isPositiveAndBelow(x, pixels.width) && juce::isPositiveAndBelow(y, pixels.height))
+            pixels.setPixelColour(x, y, traceColour);
+    }
+
+    repaint();
+}
+
+void Goniometer::paint(juce::Graphics& g)
+{
+    g.fillAll(backgroundColour);
+
+    const auto area = getLocalBounds().toFloat().withSizeKeepingCentre((float)trace.getWidth(), (float)trace.getHeight());
+    g.drawImageAt(trace, (int)area.getX(), (int)area.getY());
+
+    // L and R diagonals, the mono (mid) axis and the side axis
+    g.setColour(juce::Colours::grey.withAlpha(0.5f));
+    g.drawLine(area.getX(), area.getY(), area.getRight(), area.getBottom());
+    g.drawLine(area.getRight(), area.getY(), area.getX(), area.getBottom());
+    g.drawLine(area.getCentreX(), area.getY(), area.getCentreX(), area.getBottom());
+    g.drawLine(area.getX(), area.getCentreY(), area.getRight(), area.getCentreY());
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Metering.h"
+
+
+// Mid/side scatter of the output: mono signals draw a vertical line, wide ones
+// spread sideways, out of phase ones lie flat.
+//
+// The trace lives in a persistent image. Every refresh only dims the image a
+// little and plots the points that arrived since the last one, so the cost of
+// a frame follows the number of new points rather than the length of the
+// trail, and many open editors stay cheap.
+class Goniometer : public juce::Component, private juce::Timer
+{
+public:
+    explicit Goniometer(Metering& metering);
+    ~Goniometer() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+
+    static constexpr int refreshRate = 30;
+    // Share of the trace's brightness lost per refresh
+    static constexpr float fadePerRefresh = 0.15f;
+
+    Metering& metering;
+    std::vector<MidSideSample> points;
+    juce::Image trace;
+};
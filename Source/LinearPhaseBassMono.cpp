@@ -0,0 +1,209 @@
+#include "LinearPhaseBassMono.h"
+
+
+template <typename SampleType>
+LinearPhaseBassMono<SampleType>::LinearPhaseBassMono() = default;
+
+template <typename SampleType>
+LinearPhaseBassMono<SampleType>::~LinearPhaseBassMono()
+{
+    kernelThread->thread.removeTimeSliceClient(this);
+}
+
+template <typename SampleType>
+void LinearPhaseBassMono<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, float crossoverFrequency)
+{
+    // Waits for a kernel that is being designed right now
+    kernelThread->thread.removeTimeSliceClient(this);
+
+    active = false;
+    convolutionPrepared.store(false);
+
+    sampleRate = spec.sampleRate;
+    latency = getLatencySamples(sampleRate);
+
+    monoSpec = spec;
+    monoSpec.numChannels = 1;
+    convolutionBuffer.setSize(1, (int)spec.maximumBlockSize);
+
+    auto stereoSpec = spec;
+    stereoSpec.numChannels = 2;
+    delayLine.prepare(stereoSpec);
+    delayLine.setMaximumDelayInSamples(latency);
+    delayLine.setDelay((SampleType)latency);
+
+    requestedFrequency.store(crossoverFrequency);
+    kernelFrequency = 0.f;
+    convolvingMid = false;
+}
+
+template <typename SampleType>
+void LinearPhaseBassMono<SampleType>::activate()
+{
+    if (active)
+        return;
+
+    active = true;
+    kernelThread->thread.addTimeSliceClient(this);
+}
+
+template <typename SampleType>
+void LinearPhaseBassMono<SampleType>::reset()
+{
+    // Until then the background thread may be preparing it, which resets it too
+    if (convolutionPrepared.load(std::memory_order_acquire))
+        convolution.reset();
+
+    delayLine.reset();
+    convolutionIsStale = false;
+}
+
+template <typename SampleType>
+int LinearPhaseBassMono<SampleType>::getKernelHalfLength(double sampleRate)
+{
+    // 40 ms either side of the centre tap: a transition band of roughly 50 Hz
+    // with a Kaiser window, steep enough for crossovers from about 60 Hz up.
+    return juce::roundToInt(sampleRate * 0.04);
+}
+
+template <typename SampleType>
+int LinearPhaseBassMono<SampleType>::getLatencySamples(double sampleRate)
+{
+    return getKernelHalfLength(sampleRate) + partitionSize;
+}
+
+template <typename SampleType>
+int LinearPhaseBassMono<SampleType>::useTimeSlice()
+{
+    if (!convolutionPrepared.load(std::memory_order_relaxed))
+    {
+        convolution.prepare(monoSpec);
+        jassert(convolution.getLatency() == partitionSize);
+        convolutionPrepared.store(true, std::memory_order_release);
+    }
+
+    const auto frequency = requestedFrequency.load();
+
+    if (frequency != kernelFrequency)
+        loadKernel(frequency);
+
+    // While the crossover is swept this rebuilds the kernel at most every 20 ms,
+    // the convolution crossfades between them.
+    return 20;
+}
+
+template <typename SampleType>
+void LinearPhaseBassMono<SampleType>::loadKernel(float frequency)
+{
+    kernelFrequency = frequency;
+
+    const auto order = (size_t)(2 * getKernelHalfLength(sampleRate));
+    auto coefficients = juce::dsp::FilterDesign<float>::designFIRLowpassWindowMethod(frequency, sampleRate, order,
+                                                                                     juce::dsp::WindowingFunction<float>::kaiser, 6.f);
+
+    const auto numTaps = (int)order + 1;
+    juce::AudioBuffer<float> kernel(1, numTaps);
+    kernel.copyFrom(0, 0, coefficients->getRawCoefficients(), numTaps);
+
+    // Unity gain at DC, so the low band cancels the delayed side exactly there
+    auto sum = 0.f;
+    for (int i = 0; i < numTaps; ++i)
+        sum += kernel.getSample(0, i);
+
+    kernel.applyGain(1.f / sum);
+
+    convolution.loadImpulseResponse(std::move(kernel), sampleRate, juce::dsp::Convolution::Stereo::no,
+                                    juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+}
+
+template <typename SampleType>
+void LinearPhaseBassMono<SampleType>::process(juce::AudioBuffer<SampleType>& buffer, bool preview)
+{
+    const auto convolving = convolutionPrepared.load(std::memory_order_acquire);
+
+    // The preview convolves the mid instead of the side, and after delay() the
+    // convolution hasn't seen the input at all: its history is no use.
+    if (convolving && (preview != convolvingMid || convolutionIsStale))
+    {
+        convolution.reset();
+        convolvingMid = preview;
+        convolutionIsStale = false;
+    }
+
+    auto* leftChannel = buffer.getWritePointer(0);
+    auto* rightChannel = buffer.getWritePointer(1);
+    auto* low = convolutionBuffer.getWritePointer(0);
+
+    const auto chunkSize = convolutionBuffer.getNumSamples();
+    jassert(chunkSize > 0); // prepare() hasn't been called
+
+    for (int start = 0; start < buffer.getNumSamples(); start += chunkSize)
+    {
+        const auto numSamples = juce::jmin(chunkSize, buffer.getNumSamples() - start);
+        auto* left = leftChannel + start;
+        auto* right = rightChannel + start;
+
+        // Left and right go through the same delay as in delay(), so switching
+        // the filter on and off doesn't jump in time
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            low[sample] = (float)((preview ? left[sample] + right[sample] : left[sample] - right[sample]) * SampleType(0.5));
+
+            delayLine.pushSample(0, left[sample]);
+            delayLine.pushSample(1, right[sample]);
+            left[sample] = delayLine.popSample(0);
+            right[sample] = delayLine.popSample(1);
+        }
+
+        if (convolving)
+        {
+            auto block = juce::dsp::AudioBlock<float>(convolutionBuffer).getSubBlock(0, (size_t)numSamples);
+            auto ctx = juce::dsp::ProcessContextReplacing<float>(block);
+            convolution.process(ctx);
+        }
+        else
+        {
+            juce::FloatVectorOperations::clear(low, numSamples);
+        }
+
+        if (preview)
+        {
+            // Solo the low band: the low-passed mid on both channels
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                left[sample] = (SampleType)low[sample];
+                right[sample] = (SampleType)low[sample];
+            }
+
+            continue;
+        }
+
+        // Removing the low band from the side: L - low(side), R + low(side)
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            left[sample] -= (SampleType)low[sample];
+            right[sample] += (SampleType)low[sample];
+        }
+    }
+}
+
+template <typename SampleType>
+void LinearPhaseBassMono<SampleType>::delay(juce::AudioBuffer<SampleType>& buffer)
+{
+    for (int channel = 0; channel < juce::jmin(2, buffer.getNumChannels()); ++channel)
+    {
+        auto* channelData = buffer.getWritePointer(channel);
+
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        {
+            delayLine.pushSample(channel, channelData[sample]);
+            channelData[sample] = delayLine.popSample(channel);
+        }
+    }
+
+    convolutionIsStale = true;
+}
+
+//==============================================================================
+template class LinearPhaseBassMono<float>;
+template class LinearPhaseBassMono<double>;
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+
+// Bass mono with a linear-phase crossover: the side signal is low-passed by a
+// windowed-sinc FIR (uniformly partitioned FFT convolution) and removed from
+// the delayed input, so the mid and the high band come out unchanged apart
+// from the delay. The kernel length, and with it the latency, depends only on
+// the sample rate, so sweeping the crossover never changes the latency.
+//
+// Kernels are designed on a shared background thread; the audio thread only
+// publishes the wanted crossover frequency. The convolution crossfades to each
+// new kernel as it arrives.
+//
+// Every engine has one of these, but few ever use the mode: prepare() only
+// readies the delay. The convolution is prepared, its kernel designed and the
+// background thread polls this instance once activate() has been called.
+template <typename SampleType>
+class LinearPhaseBassMono : private juce::TimeSliceClient
+{
+public:
+    LinearPhaseBassMono();
+    ~LinearPhaseBassMono() override;
+
+    void prepare(const juce::dsp::ProcessSpec& spec, float crossoverFrequency);
+    void reset();
+
+    // Starts preparing the filter in the background, for when the mode is
+    // selected. Cheap once it has been called, but the first call after
+    // prepare() registers with the background thread, which locks: call it
+    // from prepare() or ahead of the real-time part of the audio callback.
+    void activate();
+
+    // Latency of the filter at the given sample rate, the same for every crossover frequency
+    static int getLatencySamples(double sampleRate);
+
+    void setCrossoverFrequency(float frequency) { requestedFrequency.store(frequency); }
+
+    // The convolution starts using a kernel in the first process() call after it's been loaded
+    bool isKernelLoaded() const { return convolutionPrepared.load(std::memory_order_acquire) && convolution.getCurrentIRSize() > 0; }
+
+    // Bass mono on a stereo buffer in place, or solo the low band with preview.
+    // Until the convolution is ready the low band is silent.
+    void process(juce::AudioBuffer<SampleType>& buffer, bool preview);
+
+    // Delays every channel by the latency, for channels that bypass the filter
+    void delay(juce::AudioBuffer<SampleType>& buffer);
+
+private:
+    int useTimeSlice() override;
+    void loadKernel(float frequency);
+
+    static int getKernelHalfLength(double sampleRate);
+
+    // Size of the convolution's partitions, which adds this much latency in
+    // exchange for far fewer (and larger) FFTs than a zero latency engine.
+    static constexpr int partitionSize = 256;
+
+    // One thread designs the kernels of all instances and one queue loads them
+    // into the convolution engines, instead of a thread per instance.
+    struct KernelThread
+    {
+        KernelThread() { thread.startThread(); }
+        ~KernelThread() { thread.stopThread(1000); }
+
+        juce::TimeSliceThread thread{ "Linear Phase Bass Mono" };
+        juce::dsp::ConvolutionMessageQueue queue;
+    };
+
+    juce::SharedResourcePointer<KernelThread> kernelThread;
+    juce::dsp::Convolution convolution{ juce::dsp::Convolution::Latency{ partitionSize }, kernelThread->queue };
+
+    std::atomic<float> requestedFrequency{ 120.f };
+    float kernelFrequency = 0.f;
+
+    juce::dsp::ProcessSpec monoSpec{ 44100.0, 0, 1 };
+    double sampleRate = 44100.0;
+    int latency = 0;
+    bool active = false;
+    // Set by the background thread once it has prepared the convolution
+    std::atomic<bool> convolutionPrepared{ false };
+    bool convolvingMid = false;
+    bool convolutionIsStale = false;
+
+    // Left and right delayed to line up with the convolution
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> delayLine;
+    // The convolution only runs on floats, whatever the sample type
+    juce::AudioBuffer<float> convolutionBuffer;
+};
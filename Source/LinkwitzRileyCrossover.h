@@ -0,0 +1,125 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+
+// 4th order Linkwitz-Riley crossover giving both bands from one filter, with
+// the same topology as juce::dsp::LinkwitzRileyFilter (two cascaded TPT state
+// variable filters; the high band is the allpass minus the low band).
+//
+// The coefficients for every whole Hz of the bass mono crossover range are
+// computed once in prepare(), so changing the cutoff costs a table lookup
+// instead of a tan(). While the cutoff moves it is smoothed and the
+// coefficients are interpolated from the table on every sample.
+template <typename SampleType>
+class LinkwitzRileyCrossover
+{
+public:
+    static constexpr int minimumFrequency = 20;
+    static constexpr int maximumFrequency = 500;
+    static constexpr int maximumChannels = 2;
+
+    void prepare(double sampleRate, SampleType cutoffFrequency)
+    {
+        for (int i = 0; i < tableSize; ++i)
+        {
+            const auto g = (SampleType)std::tan(juce::MathConstants<double>::pi * (minimumFrequency + i) / sampleRate);
+            table[(size_t)i] = { g, 1 / (1 + R2 * g + g * g) };
+        }
+
+        cutoff.reset(sampleRate, 0.05);
+        cutoff.setCurrentAndTargetValue(clampFrequency(cutoffFrequency));
+        coefficients = lookUp(cutoff.getCurrentValue());
+
+        reset();
+    }
+
+    // Clears the filter state and jumps to the target cutoff
+    void reset()
+    {
+        for (auto* state : { &s1, &s2, &s3, &s4 })
+            state->fill(0);
+
+        if (cutoff.isSmoothing())
+        {
+            cutoff.setCurrentAndTargetValue(cutoff.getTargetValue());
+            coefficients = lookUp(cutoff.getCurrentValue());
+        }
+    }
+
+    // Starts a sweep towards the new cutoff; nothing to do if it hasn't changed
+    void setCutoffFrequency(SampleType frequency)
+    {
+        cutoff.setTargetValue(clampFrequency(frequency));
+    }
+
+    // Steps the cutoff sweep by one sample, call once per sample before processSample()
+    void advance()
+    {
+        if (cutoff.isSmoothing())
+            coefficients = lookUp(cutoff.getNextValue());
+    }
+
+    void processSample(int channel, SampleType input, SampleType& low, SampleType& high)
+    {
+        const auto [g, h] = coefficients;
+        auto& state1 = s1[(size_t)channel];
+        auto& state2 = s2[(size_t)channel];
+        auto& state3 = s3[(size_t)channel];
+        auto& state4 = s4[(size_t)channel];
+
+        const auto yH = (input - (R2 + g) * state1 - state2) * h;
+        const auto yB = g * yH + state1;
+        state1 = g * yH + yB;
+        const auto yL = g * yB + state2;
+        state2 = g * yB + yL;
+
+        const auto yH2 = (yL - (R2 + g) * state3 - state4) * h;
+        const auto yB2 = g * yH2 + state3;
+        state3 = g * yH2 + yB2;
+        const auto yL2 = g * yB2 + state4;
+        state4 = g * yB2 + yL2;
+
+        low = yL2;
+        high = yL - R2 * yB + yH - yL2;
+    }
+
+    void snapToZero()
+    {
+        for (auto* state : { &s1, &s2, &s3, &s4 })
+            for (auto& value : *state)
+                juce::dsp::util::snapToZero(value);
+    }
+
+private:
+    struct Coefficients
+    {
+        SampleType g, h;
+    };
+
+    static constexpr int tableSize = maximumFrequency - minimumFrequency + 1;
+    static constexpr auto R2 = juce::MathConstants<SampleType>::sqrt2;
+
+    static SampleType clampFrequency(SampleType frequency)
+    {
+        return juce::jlimit((SampleType)minimumFrequency, (SampleType)maximumFrequency, frequency);
+    }
+
+    // Linear interpolation between the neighbouring whole Hz entries
+    Coefficients lookUp(SampleType frequency) const
+    {
+        const auto position = frequency - (SampleType)minimumFrequency;
+        const auto index = juce::jmin((int)position, tableSize - 2);
+        const auto fraction = position - (SampleType)index;
+        const auto& lower = table[(size_t)index];
+        const auto& upper = table[(size_t)index + 1];
+
+        return { lower.g + fraction * (upper.g - lower.g), lower.h + fraction * (upper.h - lower.h) };
+    }
+
+    std::array<Coefficients, tableSize> table{};
+    Coefficients coefficients{};
+    juce::SmoothedValue<SampleType, juce::ValueSmoothingTypes::Multiplicative> cutoff;
+
+    std::array<SampleType, maximumChannels> s1{}, s2{}, s3{}, s4{};
+};
@@ -0,0 +1,285 @@
+#include "LoudnessMeter.h"
+
+
+LoudnessMeter::LoudnessMeter()
+{
+    for (int bin = 0; bin < numBins; ++bin)
+        binEnergies[(size_t)bin] = toEnergy(minLoudness + ((float)bin + 0.5f) / binsPerLU);
+}
+
+void LoudnessMeter::prepare(double sampleRate)
+{
+    // The BS.1770 filters, derived for any sample rate from their analogue
+    // prototypes (as in libebur128) rather than the published 48 kHz coefficients
+    {
+        const auto k = std::tan(juce::MathConstants<double>::pi * 1681.974450955533 / sampleRate);
+        const auto q = 0.7071752369554196;
+        const auto vh = std::pow(10.0, 3.999843853973347 / 20.0);
+        const auto vb = std::pow(vh, 0.4996667741545416);
+        const auto a0 = 1.0 + k / q + k * k;
+
+        shelf = { (vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+                  2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+    }
+
+    {
+        const auto k = std::tan(juce::MathConstants<double>::pi * 38.13547087602444 / sampleRate);
+        const auto q = 0.5003270373238773;
+        const auto a0 = 1.0 + k / q + k * k;
+
+        highPass = { 1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+    }
+
+    stepLength = juce::jmax(1, juce::roundToInt(sampleRate / stepsPerSecond));
+
+    for (auto& state : filterState)
+        state.fill(0);
+
+    samplesInStep = 0;
+    stepEnergy = 0;
+    stepMeanSquares.fill(0);
+    stepIndex = 0;
+    numSteps = 0;
+    numTileSteps = 0;
+    tileStartInStep = 0;
+
+    momentaryLoudness.store(minLoudness);
+    shortTermLoudness.store(minLoudness);
+
+    resetRequested.store(false);
+    clearMeasurement();
+}
+
+void LoudnessMeter::clearMeasurement()
+{
+    for (auto* histogram : { &gatingBlocks, &shortTermBlocks })
+        for (auto& count : *histogram)
+            count.store(0, std::memory_order_relaxed);
+}
+
+void LoudnessMeter::beginTile()
+{
+    if (resetRequested.load(std::memory_order_relaxed) && resetRequested.exchange(false))
+        clearMeasurement();
+
+    numTileSteps = 0;
+    tileStartInStep = samplesInStep;
+}
+
+void LoudnessMeter::addToStep(int count, double energy)
+{
+    if (numTileSteps < maxStepsPerTile)
+        tileStepEnergies[(size_t)numTileSteps] = energy;
+
+    ++numTileSteps;
+    stepEnergy += energy;
+    samplesInStep += count;
+
+    if (samplesInStep == stepLength)
+        finishStep();
+}
+
+template <typename SampleType>
+void LoudnessMeter::process(const juce::AudioBuffer<SampleType>& tile, int numChannels)
+{
+    beginTile();
+
+    numChannels = juce::jmin(numChannels, tile.getNumChannels(), 2);
+    const auto numSamples = tile.getNumSamples();
+
+    for (int start = 0; start < numSamples;)
+    {
+        const auto count = juce::jmin(numSamples - start, stepLength - samplesInStep);
+        double energy = 0;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* input = tile.getReadPointer(channel, start);
+            auto [s1, s2, s3, s4] = filterState[(size_t)channel];
+
+            // Transposed direct form II, in double so the 38 Hz high-pass
+            // stays accurate at high sample rates
+            for (int sample = 0; sample < count; ++sample)
+            {
+                const auto x = (double)input[sample];
+                const auto y = shelf.b0 * x + s1;
+                s1 = shelf.b1 * x - shelf.a1 * y + s2;
+                s2 = shelf.b2 * x - shelf.a2 * y;
+
+                const auto z = highPass.b0 * y + s3;
+                s3 = highPass.b1 * y - highPass.a1 * z + s4;
+                s4 = highPass.b2 * y - highPass.a2 * z;
+
+                energy += z * z;
+            }
+
+            filterState[(size_t)channel] = { s1, s2, s3, s4 };
+        }
+
+        addToStep(count, energy);
+        start += count;
+    }
+}
+
+template <typename SampleType>
+void LoudnessMeter::processUnchanged(const juce::AudioBuffer<SampleType>& tile, int numChannels, const LoudnessMeter& source)
+{
+    // The steps of both meters start together and both see every tile, so
+    // the source's last tile split into steps the way this one's would
+    if (source.tileStartInStep != samplesInStep || source.stepLength != stepLength || source.numTileSteps > maxStepsPerTile)
+    {
+        process(tile, numChannels);
+        return;
+    }
+
+    beginTile();
+    filterState = source.filterState;
+
+    for (int step = 0, remaining = tile.getNumSamples(); remaining > 0; ++step)
+    {
+        const auto count = juce::jmin(remaining, stepLength - samplesInStep);
+        addToStep(count, source.tileStepEnergies[(size_t)step]);
+        remaining -= count;
+    }
+}
+
+void LoudnessMeter::processSilence(int numSamples)
+{
+    // What the filters would settle to, without running them over zeros
+    beginTile();
+
+    for (auto& state : filterState)
+        state.fill(0);
+
+    for (int remaining = numSamples; remaining > 0;)
+    {
+        const auto count = juce::jmin(remaining, stepLength - samplesInStep);
+        addToStep(count, 0.0);
+        remaining -= count;
+    }
+}
+
+void LoudnessMeter::finishStep()
+{
+    stepIndex = (stepIndex + 1) % stepsPerShortTerm;
+    stepMeanSquares[(size_t)stepIndex] = stepEnergy / stepLength;
+    numSteps = juce::jmin(numSteps + 1, stepsPerShortTerm);
+    stepEnergy = 0;
+    samplesInStep = 0;
+
+    auto getWindowEnergy = [this](int numWindowSteps)
+    {
+        double energy = 0;
+
+        for (int step = 0; step < numWindowSteps; ++step)
+            energy += stepMeanSquares[(size_t)((stepIndex - step + stepsPerShortTerm) % stepsPerShortTerm)];
+
+        return energy / numWindowSteps;
+    };
+
+    if (numSteps >= stepsPerMomentary)
+    {
+        const auto energy = getWindowEnergy(stepsPerMomentary);
+        momentaryLoudness.store(juce::jmax(minLoudness, toLoudness(energy)), std::memory_order_relaxed);
+        addToHistogram(gatingBlocks, energy);
+    }
+
+    if (numSteps >= stepsPerShortTerm)
+    {
+        const auto energy = getWindowEnergy(stepsPerShortTerm);
+        shortTermLoudness.store(juce::jmax(minLoudness, toLoudness(energy)), std::memory_order_relaxed);
+        addToHistogram(shortTermBlocks, energy);
+    }
+}
+
+int LoudnessMeter::getBin(float loudness)
+{
+    return juce::jlimit(0, numBins - 1, (int)std::floor((loudness - minLoudness) * binsPerLU));
+}
+
+void LoudnessMeter::addToHistogram(Histogram& histogram, double energy)
+{
+    // Absolute gate
+    const auto loudness = toLoudness(energy);
+
+    if (loudness < minLoudness)
+        return;
+
+    // Only the audio thread writes, so no read-modify-write is needed
+    auto& count = histogram[(size_t)getBin(loudness)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+double LoudnessMeter::getMeanEnergy(const Histogram& histogram, int firstBin, juce::uint32& count) const
+{
+    double energy = 0;
+    count = 0;
+
+    for (int bin = juce::jmax(0, firstBin); bin < numBins; ++bin)
+    {
+        const auto binCount = histogram[(size_t)bin].load(std::memory_order_relaxed);
+        energy += binCount * binEnergies[(size_t)bin];
+        count += binCount;
+    }
+
+    return count > 0 ? energy / count : 0.0;
+}
+
+float LoudnessMeter::getIntegratedLoudness() const
+{
+    juce::uint32 count = 0;
+    const auto ungated = getMeanEnergy(gatingBlocks, 0, count);
+
+    if (count == 0)
+        return minLoudness;
+
+    // Relative gate 10 LU below the absolute-gated loudness. Each block is
+    // counted at the centre of its bin, within 0.05 LU of its own loudness.
+    const auto relativeGate = toLoudness(ungated) - 10.f;
+    const auto gated = getMeanEnergy(gatingBlocks, getBin(relativeGate + 0.5f / binsPerLU), count);
+
+    return count > 0 ? toLoudness(gated) : minLoudness;
+}
+
+float LoudnessMeter::getLoudnessRange() const
+{
+    juce::uint32 count = 0;
+    const auto ungated = getMeanEnergy(shortTermBlocks, 0, count);
+
+    if (count == 0)
+        return 0.f;
+
+    // EBU Tech 3342: relative gate 20 LU down, then the spread between the
+    // 10th and 95th percentiles of the short-term loudness
+    const auto firstBin = getBin(toLoudness(ungated) - 20.f + 0.5f / binsPerLU);
+    getMeanEnergy(shortTermBlocks, firstBin, count);
+
+    if (count == 0)
+        return 0.f;
+
+    int lowBin = -1, highBin = -1;
+    juce::uint32 cumulative = 0;
+
+    for (int bin = firstBin; bin < numBins && highBin < 0; ++bin)
+    {
+        cumulative += shortTermBlocks[(size_t)bin].load(std::memory_order_relaxed);
+
+        if (lowBin < 0 && cumulative >= 0.10 * count)
+            lowBin = bin;
+
+        if (cumulative >= 0.95 * count)
+            highBin = bin;
+    }
+
+    // The histogram may have grown since it was counted above
+    if (lowBin < 0 || highBin < 0)
+        return 0.f;
+
+    return (float)(highBin - lowBin) / binsPerLU;
+}
+
+//==============================================================================
+template void LoudnessMeter::process(const juce::AudioBuffer<float>&, int);
+template void LoudnessMeter::process(const juce::AudioBuffer<double>&, int);
+template void LoudnessMeter::processUnchanged(const juce::AudioBuffer<float>&, int, const LoudnessMeter&);
+template void LoudnessMeter::processUnchanged(const juce::AudioBuffer<double>&, int, const LoudnessMeter&);
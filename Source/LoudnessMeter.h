@@ -0,0 +1,111 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+
+// ITU-R BS.1770 / EBU R128 loudness of a stereo signal: momentary (400 ms),
+// short-term (3 s), integrated and loudness range.
+//
+// The audio thread K-weights the signal and sums its energy over 100 ms
+// steps; every step completes a 400 ms gating block (75% overlap) and a 3 s
+// short-term window. Those are counted in fixed 0.1 LU histograms instead of
+// being stored, so integrated loudness and loudness range need the same
+// memory after an hour as after a second, and are evaluated on demand from
+// the histograms by the message thread.
+//
+// Surround buses are measured on their front left/right pair, like the other
+// meters. A mono signal is measured as one channel.
+class LoudnessMeter
+{
+public:
+    LoudnessMeter();
+
+    // Also resets the measurement
+    void prepare(double sampleRate);
+
+    // Audio thread
+    template <typename SampleType>
+    void process(const juce::AudioBuffer<SampleType>& tile, int numChannels);
+
+    // Audio thread, instead of process() for a tile that source has just
+    // measured with the same number of channels: takes over its filter state
+    // and energies rather than filtering the same samples again. Falls back
+    // to process() if the two meters aren't in step.
+    template <typename SampleType>
+    void processUnchanged(const juce::AudioBuffer<SampleType>& tile, int numChannels, const LoudnessMeter& source);
+
+    // Audio thread, instead of process() for a tile of digital silence
+    void processSilence(int numSamples);
+
+    // Any thread; minLoudness until there is enough signal to measure
+    float getMomentaryLoudness() const { return momentaryLoudness.load(std::memory_order_relaxed); }
+    float getShortTermLoudness() const { return shortTermLoudness.load(std::memory_order_relaxed); }
+
+    // Message thread, a pass over the histograms
+    float getIntegratedLoudness() const;
+    float getLoudnessRange() const;
+
+    // Restarts the integrated loudness and loudness range at the next block
+    void requestReset() { resetRequested.store(true); }
+
+    // LUFS; quieter blocks are ignored by the absolute gate. The top covers a
+    // full scale input (about +7 LUFS with the K-weighting's treble boost)
+    // plus the +50 dB of the Gain parameter, so hot output isn't clamped.
+    static constexpr float minLoudness = -70.f;
+    static constexpr float maxLoudness = 70.f;
+
+private:
+    struct Biquad
+    {
+        double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    };
+
+    void clearMeasurement();
+    void beginTile();
+    // Adds the energy of the next count samples of the tile, up to the end of the step
+    void addToStep(int count, double energy);
+    void finishStep();
+
+    static double toEnergy(float loudness) { return std::pow(10.0, (loudness + 0.691) / 10.0); }
+    static float toLoudness(double energy) { return energy > 0 ? (float)(-0.691 + 10.0 * std::log10(energy)) : -std::numeric_limits<float>::infinity(); }
+
+    static constexpr int stepsPerSecond = 10;
+    static constexpr int stepsPerMomentary = 4;
+    static constexpr int stepsPerShortTerm = 30;
+
+    static constexpr float binsPerLU = 10.f;
+    static constexpr int numBins = (int)((maxLoudness - minLoudness) * binsPerLU);
+
+    using Histogram = std::array<std::atomic<juce::uint32>, (size_t)numBins>;
+
+    static void addToHistogram(Histogram& histogram, double energy);
+    // Mean energy of the histogram's blocks from firstBin on, and their number
+    double getMeanEnergy(const Histogram& histogram, int firstBin, juce::uint32& count) const;
+    static int getBin(float loudness);
+
+    // K-weighting: a high shelf for the head, then a high-pass (RLB)
+    Biquad shelf, highPass;
+    std::array<std::array<double, 4>, 2> filterState{};
+
+    int stepLength = 4410;
+    int samplesInStep = 0;
+    double stepEnergy = 0;
+
+    // Mean square of the last short-term window's steps, newest at stepIndex
+    std::array<double, stepsPerShortTerm> stepMeanSquares{};
+    int stepIndex = 0;
+    int numSteps = 0;
+
+    // The energy added to each step by the last tile, for processUnchanged().
+    // A tile of at most 1024 samples spans a few steps at any usual sample rate.
+    static constexpr int maxStepsPerTile = 8;
+    std::array<double, maxStepsPerTile> tileStepEnergies{};
+    int numTileSteps = 0;
+    int tileStartInStep = 0;
+
+    Histogram gatingBlocks, shortTermBlocks;
+    std::array<double, (size_t)numBins> binEnergies{};
+
+    std::atomic<float> momentaryLoudness{ minLoudness }, shortTermLoudness{ minLoudness };
+    std::atomic<bool> resetRequested{ false };
+};
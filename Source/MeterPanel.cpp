@@ -0,0 +1,193 @@
+#include "MeterPanel.h"
+#include "Font.h"
+
+
+MeterPanel::MeterPanel(Metering& m, LoudnessMeter& inputLoudnessToShow, LoudnessMeter& outputLoudnessToShow)
+    : metering(m),
+      inputLoudnessMeter(inputLoudnessToShow),
+      outputLoudnessMeter(outputLoudnessToShow)
+{
+    setName("Meter Panel");
+
+    // Anything left over from an earlier editor is stale
+    MeterFrame frame;
+    metering.read(frame);
+    metering.addViewer();
+
+    startTimerHz(refreshRate);
+}
+
+MeterPanel::~MeterPanel()
+{
+    metering.removeViewer();
+}
+
+void MeterPanel::Ballistics::update(const MeterLevels& levels, int numSamples, float peakFall, float averaging)
+{
+    for (size_t channel = 0; channel < 2; ++channel)
+    {
+        const auto peak = juce::Decibels::gainToDecibels(levels.peak[channel], minDecibels);
+        peakDecibels[channel] = juce::jmax(peak, peakDecibels[channel] - peakFall);
+
+        // No audio since the last refresh (e.g. the host stopped calling us) decays to silence
+        const auto blockMeanSquare = numSamples > 0 ? levels.squares[channel] / (float)numSamples : 0.f;
+        meanSquare[channel] += averaging * (blockMeanSquare - meanSquare[channel]);
+    }
+
+    const auto blockMeanProduct = numSamples > 0 ? levels.product / (float)numSamples : 0.f;
+    meanProduct += averaging * (blockMeanProduct - meanProduct);
+}
+
+void MeterPanel::LoudnessReadout::update(const LoudnessMeter& meter)
+{
+    momentary = meter.getMomentaryLoudness();
+    shortTerm = meter.getShortTermLoudness();
+    integrated = meter.getIntegratedLoudness();
+    range = meter.getLoudnessRange();
+}
+
+void MeterPanel::mouseDown(const juce::MouseEvent&)
+{
+    inputLoudnessMeter.requestReset();
+    outputLoudnessMeter.requestReset();
+    metering.getTruePeakMeter().requestReset();
+}
+
+void MeterPanel::timerCallback()
+{
+    MeterFrame frame;
+
+    if (!metering.read(frame))
+        frame = {};
+
+    const auto interval = 1.f / (float)refreshRate;
+    const auto peakFall = peakFallDecibelsPerSecond * interval;
+    const auto averaging = 1.f - std::exp(-interval / averagingSeconds);
+
+    input.update(frame.input, frame.numSamples, peakFall, averaging);
+    output.update(frame.output, frame.numSamples, peakFall, averaging);
+
+    inputLoudness.update(inputLoudnessMeter);
+    outputLoudness.update(outputLoudnessMeter);
+
+    const auto& truePeakMeter = metering.getTruePeakMeter();
+    truePeak = juce::Decibels::gainToDecibels(juce::jmax(truePeakMeter.getMaxTruePeak(0), truePeakMeter.getMaxTruePeak(1)), minDecibels);
+
+    repaint();
+}
+
+//==============================================================================
+void MeterPanel::paint(juce::Graphics& g)
+{
+    auto area = getLocalBounds().toFloat().reduced(10.f, 5.f);
+    auto correlationArea = area.removeFromBottom(14.f);
+    area.removeFromBottom(5.f);
+    auto loudnessArea = area.removeFromBottom(28.f);
+    area.removeFromBottom(3.f);
+    auto truePeakArea = area.removeFromBottom(14.f);
+    area.removeFromBottom(3.f);
+
+    // Input under the input column, output under the output column
+    const auto columnGap = 20.f;
+    const auto columnWidth = (area.getWidth() - columnGap) / 2.f;
+    drawLevels(g, area.removeFromLeft(columnWidth), input);
+    drawLevels(g, area.removeFromRight(columnWidth), output);
+    drawLoudness(g, loudnessArea.removeFromLeft(columnWidth), inputLoudness);
+    drawLoudness(g, loudnessArea.removeFromRight(columnWidth), outputLoudness);
+    drawTruePeak(g, truePeakArea.removeFromRight(columnWidth));
+
+    drawCorrelation(g, correlationArea);
+}
+
+void MeterPanel::drawLevels(juce::Graphics& g, juce::Rectangle<float> area, const Ballistics& levels) const
+{
+    auto toProportion = [](float decibels)
+    {
+        return juce::jlimit(0.f, 1.f, (decibels - minDecibels) / (maxDecibels - minDecibels));
+    };
+
+    const auto zeroDecibels = toProportion(0.f);
+    const auto barHeight = (area.getHeight() - 3.f) / 2.f;
+
+    for (size_t channel = 0; channel < 2; ++channel)
+    {
+        auto bar = area.removeFromTop(barHeight);
+        area.removeFromTop(3.f);
+
+        g.setColour(juce::Colours::grey.withAlpha(0.3f));
+        g.fillRect(bar);
+
+        const auto rms = juce::Decibels::gainToDecibels(std::sqrt(levels.meanSquare[channel]), minDecibels);
+        g.setColour(juce::Colours::darkgrey);
+        g.fillRect(bar.withWidth(bar.getWidth() * toProportion(rms)));
+
+        const auto peak = levels.peakDecibels[channel];
+        g.setColour(peak > 0.f ? juce::Colours::red : juce::Colours::black);
+        g.fillRect(bar.getX() + bar.getWidth() * toProportion(peak) - 1.f, bar.getY(), 2.f, bar.getHeight());
+
+        g.setColour(juce::Colours::grey);
+        g.drawVerticalLine(juce::roundToInt(bar.getX() + bar.getWidth() * zeroDecibels), bar.getY(), bar.getBottom());
+    }
+}
+
+void MeterPanel::drawLoudness(juce::Graphics& g, juce::Rectangle<float> area, const LoudnessReadout& loudness) const
+{
+    auto format = [](float lufs)
+    {
+        return lufs > LoudnessMeter::minLoudness ? juce::String(lufs, 1) : juce::String("-");
+    };
+
+    const auto lineHeight = area.getHeight() / 2.f;
+
+    g.setColour(juce::Colours::black);
+    g.setFont(Fonts::getRegular(FontHeight::S).withHeight(juce::jmin(lineHeight, 13.f)));
+    g.drawText("M " + format(loudness.momentary) + "  S " + format(loudness.shortTerm),
+               area.removeFromTop(lineHeight), juce::Justification::centredLeft);
+    g.drawText("I " + format(loudness.integrated) + "  LRA " + juce::String(loudness.range, 1),
+               area, juce::Justification::centredLeft);
+}
+
+void MeterPanel::drawTruePeak(juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    // EBU R128 allows at most -1 dBTP
+    g.setColour(truePeak > -1.f ? juce::Colours::red : juce::Colours::black);
+    g.setFont(Fonts::getRegular(FontHeight::S).withHeight(juce::jmin(area.getHeight(), 13.f)));
+    g.drawText("TP " + (truePeak > minDecibels ? juce::String(truePeak, 1) : juce::String("-")) + " dBTP",
+               area, juce::Justification::centredLeft);
+}
+
+void MeterPanel::drawCorrelation(juce::Graphics& g, juce::Rectangle<float> area) const
+{
+    const auto leftSquare = output.meanSquare[0];
+    const auto rightSquare = output.meanSquare[1];
+    const auto silent = leftSquare * rightSquare <= 1.0e-12f;
+
+    // +1 in phase, 0 unrelated, -1 out of phase
+    const auto correlation = silent ? 0.f : juce::jlimit(-1.f, 1.f, output.meanProduct / std::sqrt(leftSquare * rightSquare));
+
+    juce::String balance("C");
+
+    if (!silent)
+    {
+        const auto decibels = 10.f * std::log10(leftSquare / rightSquare);
+
+        if (std::abs(decibels) >= 0.1f)
+            balance = juce::String(decibels > 0.f ? "L " : "R ") + juce::String(std::abs(decibels), 1) + " dB";
+    }
+
+    g.setColour(juce::Colours::black);
+    g.setFont(Fonts::getRegular(FontHeight::S).withHeight(juce::jmin(area.getHeight(), 14.f)));
+    g.drawText(balance, area.removeFromRight(70.f), juce::Justification::centredRight);
+    area.removeFromRight(10.f);
+
+    g.setColour(juce::Colours::grey.withAlpha(0.3f));
+    g.fillRect(area);
+
+    const auto centre = area.getCentreX();
+    const auto position = centre + correlation * area.getWidth() / 2.f;
+    g.setColour(correlation < 0.f ? juce::Colours::red : juce::Colours::darkgrey);
+    g.fillRect(juce::jmin(centre, position), area.getY(), std::abs(position - centre), area.getHeight());
+
+    g.setColour(juce::Colours::grey);
+    g.drawVerticalLine(juce::roundToInt(centre), area.getY(), area.getBottom());
+}
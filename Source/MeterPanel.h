@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Metering.h"
+#include "LoudnessMeter.h"
+
+
+// Input and output peak/RMS bars and loudness, a phase correlation meter and
+// the L/R balance of the output. Keeps the processor's metering on while it
+// exists and polls it from a timer, so the audio thread never talks to the UI.
+// Clicking the panel restarts the integrated loudness, loudness range and the
+// output's held true peak.
+class MeterPanel : public juce::Component, private juce::Timer
+{
+public:
+    MeterPanel(Metering& metering, LoudnessMeter& inputLoudness, LoudnessMeter& outputLoudness);
+    ~MeterPanel() override;
+
+    void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent& e) override;
+
+private:
+    void timerCallback() override;
+
+    // Meter ballistics for one side of the plugin
+    struct Ballistics
+    {
+        void update(const MeterLevels& levels, int numSamples, float peakFall, float averaging);
+
+        std::array<float, 2> peakDecibels{ minDecibels, minDecibels };
+        std::array<float, 2> meanSquare{};
+        float meanProduct = 0;
+    };
+
+    // Loudness values as of the last refresh, in LUFS and LU
+    struct LoudnessReadout
+    {
+        void update(const LoudnessMeter& meter);
+
+        float momentary = LoudnessMeter::minLoudness, shortTerm = LoudnessMeter::minLoudness;
+        float integrated = LoudnessMeter::minLoudness, range = 0;
+    };
+
+    void drawLevels(juce::Graphics& g, juce::Rectangle<float> area, const Ballistics& levels) const;
+    void drawLoudness(juce::Graphics& g, juce::Rectangle<float> area, const LoudnessReadout& loudness) const;
+    void drawTruePeak(juce::Graphics& g, juce::Rectangle<float> area) const;
+    void drawCorrelation(juce::Graphics& g, juce::Rectangle<float> area) const;
+
+    static constexpr float minDecibels = -60.f;
+    static constexpr float maxDecibels = 6.f;
+    static constexpr int refreshRate = 30;
+    // Peaks fall back at this rate, RMS and correlation average over about this long
+    static constexpr float peakFallDecibelsPerSecond = 24.f;
+    static constexpr float averagingSeconds = 0.3f;
+
+    Metering& metering;
+    Ballistics input, output;
+
+    LoudnessMeter& inputLoudnessMeter;
+    LoudnessMeter& outputLoudnessMeter;
+    LoudnessReadout inputLoudness, outputLoudness;
+    // Of the louder output channel, dBTP
+    float truePeak = minDecibels;
+};
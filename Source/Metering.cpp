@@ -0,0 +1,164 @@
+#include "Metering.h"
+#include "StereoKernels.h"
+
+
+void Metering::prepare(double newSampleRate)
+{
+    sampleRate.store(newSampleRate);
+    scopeDecimation = juce::jmax(1, juce::roundToInt(newSampleRate / scopePointRate));
+    samplesUntilScopePoint = 0;
+}
+
+template <typename SampleType>
+void Metering::measure(const juce::AudioBuffer<SampleType>& tile, int numChannels, MeterLevels& levels)
+{
+    if (numChannels < 1)
+        return;
+
+    const auto numSamples = tile.getNumSamples();
+    const SampleType* channels[] = { tile.getReadPointer(0), tile.getReadPointer(numChannels > 1 ? 1 : 0) };
+
+    for (size_t channel = 0; channel < 2; ++channel)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(channels[channel], numSamples);
+        levels.peak[channel] = juce::jmax(levels.peak[channel], (float)-range.getStart(), (float)range.getEnd());
+    }
+
+    SampleType sums[3] = {};
+    StereoKernels<SampleType>::get().sumProducts(channels[0], channels[1], numSamples, sums);
+
+    levels.squares[0] += (float)sums[0];
+    levels.squares[1] += (float)sums[1];
+    levels.product += (float)sums[2];
+}
+
+template <typename SampleType>
+void Metering::measureInput(const juce::AudioBuffer<SampleType>& tile, int numInputChannels)
+{
+    measure(tile, juce::jmin(numInputChannels, tile.getNumChannels()), currentFrame.input);
+}
+
+template <typename SampleType>
+void Metering::measureOutput(const juce::AudioBuffer<SampleType>& tile)
+{
+    measure(tile, tile.getNumChannels(), currentFrame.output);
+    currentFrame.numSamples += tile.getNumSamples();
+    truePeak.process(tile);
+
+    if (tile.getNumChannels() > 0)
+    {
+        const auto* left = tile.getReadPointer(0);
+        const auto* right = tile.getReadPointer(juce::jmin(1, tile.getNumChannels() - 1));
+        pushScopePoints(left, right, tile.getNumSamples());
+        pushAnalyserSamples(left, right, tile.getNumSamples());
+    }
+}
+
+template <typename SampleType>
+void Metering::pushScopePoints(const SampleType* left, const SampleType* right, int numSamples)
+{
+    auto sample = samplesUntilScopePoint;
+    const auto numPoints = sample < numSamples ? (numSamples - 1 - sample) / scopeDecimation + 1 : 0;
+    samplesUntilScopePoint = sample + numPoints * scopeDecimation - numSamples;
+
+    // Whatever doesn't fit is dropped, the phase of the decimation carries on
+    const auto scope = scopeFifo.write(juce::jmin(numPoints, scopeFifo.getFreeSpace()));
+
+    scope.forEach([&](int index)
+    {
+        const auto l = (float)left[sample];
+        const auto r = (float)right[sample];
+        scopePoints[(size_t)index] = { 0.5f * (l + r), 0.5f * (l - r) };
+        sample += scopeDecimation;
+    });
+}
+
+void Metering::finishBlock()
+{
+    {
+        const auto scope = fifo.write(1);
+
+        if (scope.blockSize1 > 0)
+            frames[(size_t)scope.startIndex1] = currentFrame;
+    }
+
+    currentFrame = {};
+}
+
+bool Metering::read(MeterFrame& frame)
+{
+    const auto scope = fifo.read(fifo.getNumReady());
+
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+        return false;
+
+    frame = {};
+
+    auto merge = [](MeterLevels& total, const MeterLevels& levels)
+    {
+        for (size_t channel = 0; channel < 2; ++channel)
+        {
+            total.peak[channel] = juce::jmax(total.peak[channel], levels.peak[channel]);
+            total.squares[channel] += levels.squares[channel];
+        }
+
+        total.product += levels.product;
+    };
+
+    scope.forEach([&](int index)
+    {
+        const auto& block = frames[(size_t)index];
+        merge(frame.input, block.input);
+        merge(frame.output, block.output);
+        frame.numSamples += block.numSamples;
+    });
+
+    return true;
+}
+
+template <typename SampleType>
+void Metering::pushAnalyserSamples(const SampleType* left, const SampleType* right, int numSamples)
+{
+    const auto scope = analyserFifo.write(juce::jmin(numSamples, analyserFifo.getFreeSpace()));
+    auto sample = 0;
+
+    scope.forEach([&](int index)
+    {
+        const auto l = (float)left[sample];
+        const auto r = (float)right[sample];
+        analyserSamples[(size_t)index] = { 0.5f * (l + r), 0.5f * (l - r) };
+        ++sample;
+    });
+}
+
+int Metering::readScopePoints(MidSideSample* points, int maxPoints)
+{
+    const auto scope = scopeFifo.read(juce::jmin(maxPoints, scopeFifo.getNumReady()));
+    auto numPoints = 0;
+
+    scope.forEach([&](int index)
+    {
+        points[numPoints++] = scopePoints[(size_t)index];
+    });
+
+    return numPoints;
+}
+
+int Metering::readAnalyserSamples(MidSideSample* samples, int maxSamples)
+{
+    const auto scope = analyserFifo.read(juce::jmin(maxSamples, analyserFifo.getNumReady()));
+    auto numSamples = 0;
+
+    scope.forEach([&](int index)
+    {
+        samples[numSamples++] = analyserSamples[(size_t)index];
+    });
+
+    return numSamples;
+}
+
+//==============================================================================
+template void Metering::measureInput(const juce::AudioBuffer<float>&, int);
+template void Metering::measureInput(const juce::AudioBuffer<double>&, int);
+template void Metering::measureOutput(const juce::AudioBuffer<float>&);
+template void Metering::measureOutput(const juce::AudioBuffer<double>&);
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TruePeakMeter.h"
+
+
+// Levels of the front left/right pair at one point of the chain
+struct MeterLevels
+{
+    std::array<float, 2> peak{};
+    // Sums over the measured samples: L * L and R * R, and L * R for the correlation
+    std::array<float, 2> squares{};
+    float product = 0;
+};
+
+// One output sample as mid = (L + R) / 2 and side = (L - R) / 2
+struct MidSideSample
+{
+    float mid, side;
+};
+
+// What the meters saw during one host block
+struct MeterFrame
+{
+    MeterLevels input, output;
+    int numSamples = 0;
+};
+
+// Measures the plugin's input and output on the audio thread and hands the
+// results to the editor. The audio thread pushes one frame per host block into
+// a preallocated single-producer/single-consumer FIFO and never waits: if the
+// editor falls behind, frames are dropped instead.
+//
+// The output is also decimated into a second FIFO of mid/side points for the
+// goniometer, and copied at full rate into a third one for the spectrum
+// analyser, both dropping samples the same way. The output's true peak is
+// measured alongside.
+//
+// Measuring is skipped altogether while no editor component is watching.
+class Metering
+{
+public:
+    void prepare(double sampleRate);
+    double getSampleRate() const { return sampleRate.load(); }
+
+    // Message thread: components showing the meters register while they exist
+    void addViewer() { ++numViewers; }
+    void removeViewer() { --numViewers; }
+    bool isEnabled() const { return numViewers.load(std::memory_order_relaxed) > 0; }
+
+    // Audio thread, for every tile of a block, then finishBlock() once.
+    // A mono input or output is measured as both left and right.
+    template <typename SampleType>
+    void measureInput(const juce::AudioBuffer<SampleType>& tile, int numInputChannels);
+    template <typename SampleType>
+    void measureOutput(const juce::AudioBuffer<SampleType>& tile);
+    void finishBlock();
+
+    // Message thread: merges every frame published since the last call into
+    // one. Returns false if there was none.
+    bool read(MeterFrame& frame);
+
+    // Held true peak of the output, measured only while the meters are shown
+    TruePeakMeter& getTruePeakMeter() { return truePeak; }
+
+    // Message thread: copies up to maxPoints of the oldest goniometer points
+    // and returns how many
+    int readScopePoints(MidSideSample* points, int maxPoints);
+
+    // The goniometer FIFO holds this many points
+    static constexpr int scopeFifoSize = 8192;
+
+    // Message thread or a worker: copies up to maxSamples of the oldest
+    // spectrum analyser samples and returns how many
+    int readAnalyserSamples(MidSideSample* samples, int maxSamples);
+
+    // About 85 ms at 192 kHz, several refreshes of the analyser
+    static constexpr int analyserFifoSize = 16384;
+
+private:
+    template <typename SampleType>
+    static void measure(const juce::AudioBuffer<SampleType>& tile, int numChannels, MeterLevels& levels);
+    template <typename SampleType>
+    void pushScopePoints(const SampleType* left, const SampleType* right, int numSamples);
+    template <typename SampleType>
+    void pushAnalyserSamples(const SampleType* left, const SampleType* right, int numSamples);
+
+    // Blocks, not tiles, so this covers several refreshes of the editor even
+    // with very small host buffers
+    static constexpr int fifoSize = 128;
+
+    juce::AbstractFifo fifo{ fifoSize };
+    std::array<MeterFrame, fifoSize> frames;
+    MeterFrame currentFrame;
+
+    // The goniometer shows about this many points per second, whatever the
+    // sample rate: plenty for a dense trace, and a bounded amount of drawing
+    static constexpr double scopePointRate = 12000.0;
+
+    juce::AbstractFifo scopeFifo{ scopeFifoSize };
+    std::array<MidSideSample, scopeFifoSize> scopePoints;
+    int scopeDecimation = 4;
+    int samplesUntilScopePoint = 0;
+
+    juce::AbstractFifo analyserFifo{ analyserFifoSize };
+    std::array<MidSideSample, analyserFifoSize> analyserSamples;
+
+    TruePeakMeter truePeak;
+
+    std::atomic<double> sampleRate{ 44100.0 };
+
+    std::atomic<int> numViewers{ 0 };
+};
@@ -0,0 +1,193 @@
+#include "MultichannelEngine.h"
+
+
+template <typename SampleType>
+void MultichannelEngine<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, const juce::AudioChannelSet& layout, const UtilityParameters& parameters)
+{
+    using ChannelType = juce::AudioChannelSet::ChannelType;
+
+    // The first entry is the front pair
+    static constexpr std::pair<ChannelType, ChannelType> pairTypes[] =
+    {
+        { juce::AudioChannelSet::left,              juce::AudioChannelSet::right },
+        { juce::AudioChannelSet::leftSurround,      juce::AudioChannelSet::rightSurround },
+        { juce::AudioChannelSet::leftSurroundSide,  juce::AudioChannelSet::rightSurroundSide },
+        { juce::AudioChannelSet::leftSurroundRear,  juce::AudioChannelSet::rightSurroundRear },
+        { juce::AudioChannelSet::wideLeft,          juce::AudioChannelSet::wideRight },
+        { juce::AudioChannelSet::leftCentre,        juce::AudioChannelSet::rightCentre },
+        { juce::AudioChannelSet::topFrontLeft,      juce::AudioChannelSet::topFrontRight },
+        { juce::AudioChannelSet::topSideLeft,       juce::AudioChannelSet::topSideRight },
+        { juce::AudioChannelSet::topRearLeft,       juce::AudioChannelSet::topRearRight },
+    };
+
+    pairs.clearQuick();
+    singleChannels.clearQuick();
+
+    const auto numChannels = (int)spec.numChannels;
+    juce::Array<bool> isPaired;
+    isPaired.insertMultiple(0, false, numChannels);
+
+    for (const auto& [leftType, rightType] : pairTypes)
+    {
+        const auto left = layout.getChannelIndexForType(leftType);
+        const auto right = layout.getChannelIndexForType(rightType);
+
+        if (left >= 0 && right >= 0 && left < numChannels && right < numChannels)
+        {
+            pairs.add({ left, right, leftType == juce::AudioChannelSet::left });
+            isPaired.set(left, true);
+            isPaired.set(right, true);
+        }
+    }
+
+    // Discrete layouts without channel types: treat the first two channels as the front pair
+    if (pairs.isEmpty() && numChannels >= 2)
+    {
+        pairs.add({ 0, 1, true });
+        isPaired.set(0, true);
+        isPaired.set(1, true);
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        if (!isPaired[channel])
+            singleChannels.add(channel);
+
+    lfeChannel = layout.getChannelIndexForType(juce::AudioChannelSet::LFE);
+
+    auto pairSpec = spec;
+    pairSpec.numChannels = 2;
+    auto singleSpec = spec;
+    singleSpec.numChannels = 1;
+
+    pairEngines.clear();
+    for (const auto& pair : pairs)
+        pairEngines.add(new UtilityEngine<SampleType>())->prepare(pairSpec, pair.isFront ? parameters : withoutStereoStages(parameters));
+
+    singleChannelEngines.clear();
+    for (int i = 0; i < singleChannels.size(); ++i)
+        singleChannelEngines.add(new UtilityEngine<SampleType>())->prepare(singleSpec, pairs.isEmpty() ? parameters : withoutStereoStages(parameters));
+
+#if UTILITY_ENABLE_PROFILING
+    setProfiler(profiler);
+#endif
+}
+
+template <typename SampleType>
+void MultichannelEngine<SampleType>::reset()
+{
+    for (auto* engine : pairEngines)
+        engine->reset();
+
+    for (auto* engine : singleChannelEngines)
+        engine->reset();
+}
+
+template <typename SampleType>
+void MultichannelEngine<SampleType>::activateLinearPhase()
+{
+    // Single channels never run the filter, they only delay
+    for (auto* engine : pairEngines)
+        engine->activateLinearPhase();
+}
+
+template <typename SampleType>
+bool MultichannelEngine<SampleType>::isReady(const UtilityParameters& parameters) const
+{
+    // Single channels never run the linear phase filter, they only delay
+    for (int i = 0; i < pairs.size(); ++i)
+    {
+        const auto applyStereoStages = pairs.getReference(i).isFront || parameters.allPairs;
+
+        if (!pairEngines.getUnchecked(i)->isReady(applyStereoStages ? parameters : withoutStereoStages(parameters)))
+            return false;
+    }
+
+    return true;
+}
+
+#if UTILITY_ENABLE_PROFILING
+template <typename SampleType>
+void MultichannelEngine<SampleType>::setProfiler(DspProfiler* profilerToUse)
+{
+    profiler = profilerToUse;
+
+    for (auto* engine : pairEngines)
+        engine->setProfiler(profiler);
+
+    for (auto* engine : singleChannelEngines)
+        engine->setProfiler(profiler);
+}
+#endif
+
+template <typename SampleType>
+UtilityParameters MultichannelEngine<SampleType>::withoutStereoStages(UtilityParameters parameters)
+{
+    parameters.balance = 0.f;
+    parameters.width = 1.f;
+    parameters.midSide = 0.f;
+    parameters.mode = 0;
+    parameters.midSideMode = false;
+    parameters.mono = false;
+    parameters.bassMono = false;
+    parameters.invertLeft = false;
+    parameters.invertRight = false;
+    return parameters;
+}
+
+template <typename SampleType>
+TileResult MultichannelEngine<SampleType>::process(juce::AudioBuffer<SampleType>& buffer, int numInputChannels, const UtilityParameters& parameters)
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto nonStereoParameters = withoutStereoStages(parameters);
+
+    // A mono bus has no pairs, its only channel gets all the parameters
+    const auto& singleChannelParameters = pairs.isEmpty() ? parameters : nonStereoParameters;
+
+    // Bass management: the low band of every pair goes to the LFE instead of
+    // being summed back into the pair. The LFE channel is processed last, so
+    // gain, mute and DC apply to it. The linear phase mode delays the LFE like
+    // any other channel, which would delay the routed low band twice, so it
+    // keeps the low band in the pairs.
+    auto* lowBandOutput = parameters.bassToLFE && parameters.bassMono && !parameters.bassMonoPreview && lfeChannel >= 0
+                       && parameters.bassMonoMode != UtilityParameters::linearPhaseBassMono
+                        ? buffer.getWritePointer(lfeChannel)
+                        : nullptr;
+
+    auto result = TileResult::unchanged;
+    auto isFirst = true;
+
+    auto combine = [&result, &isFirst](TileResult engineResult)
+    {
+        result = isFirst || result == engineResult ? engineResult : TileResult::processed;
+        isFirst = false;
+    };
+
+    for (int i = 0; i < pairs.size(); ++i)
+    {
+        const auto& pair = pairs.getReference(i);
+        const auto applyStereoStages = pair.isFront || parameters.allPairs;
+
+        SampleType* channels[] = { buffer.getWritePointer(pair.left), buffer.getWritePointer(pair.right) };
+        juce::AudioBuffer<SampleType> pairBuffer(channels, 2, numSamples);
+
+        // Mono to stereo: only the left of the front pair is fed by the input
+        const auto numPairInputs = pair.right < numInputChannels ? 2 : 1;
+
+        combine(pairEngines.getUnchecked(i)->process(pairBuffer, numPairInputs, applyStereoStages ? parameters : nonStereoParameters,
+                                                     applyStereoStages ? lowBandOutput : nullptr));
+    }
+
+    for (int i = 0; i < singleChannels.size(); ++i)
+    {
+        SampleType* channels[] = { buffer.getWritePointer(singleChannels.getUnchecked(i)) };
+        juce::AudioBuffer<SampleType> channelBuffer(channels, 1, numSamples);
+
+        combine(singleChannelEngines.getUnchecked(i)->process(channelBuffer, 1, singleChannelParameters));
+    }
+
+    return result;
+}
+
+//==============================================================================
+template class MultichannelEngine<float>;
+template class MultichannelEngine<double>;
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "UtilityEngine.h"
+
+
+// Runs the plugin's DSP over any of the supported bus layouts: left/right
+// style channel pairs of the layout (L/R, Ls/Rs, Lrs/Rrs, top pairs ...) each
+// get their own stereo UtilityEngine, every other channel (C, LFE, ...) a mono
+// one that only applies gain, mute and DC.
+template <typename SampleType>
+class MultichannelEngine
+{
+public:
+    void prepare(const juce::dsp::ProcessSpec& spec, const juce::AudioChannelSet& layout, const UtilityParameters& parameters);
+    void reset();
+
+    // Unchanged or silent only if that goes for every channel
+    TileResult process(juce::AudioBuffer<SampleType>& buffer, int numInputChannels, const UtilityParameters& parameters);
+
+    // Starts preparing the linear phase filters of the pairs, for once that
+    // mode is selected. See LinearPhaseBassMono::activate() for where to call it.
+    void activateLinearPhase();
+
+    // See UtilityEngine::isReady()
+    bool isReady(const UtilityParameters& parameters) const;
+
+#if UTILITY_ENABLE_PROFILING
+    // Handed to the engines of every pair and channel, see UtilityEngine::setProfiler()
+    void setProfiler(DspProfiler* profilerToUse);
+#endif
+
+private:
+    struct ChannelPair
+    {
+        int left, right;
+        bool isFront;
+    };
+
+    // Parameters for pairs and channels that width, balance etc. don't apply to
+    static UtilityParameters withoutStereoStages(UtilityParameters parameters);
+
+    juce::Array<ChannelPair> pairs;
+    juce::Array<int> singleChannels;
+    int lfeChannel = -1;
+
+    juce::OwnedArray<UtilityEngine<SampleType>> pairEngines, singleChannelEngines;
+
+#if UTILITY_ENABLE_PROFILING
+    DspProfiler* profiler = nullptr;
+#endif
+};
@@ -13,8 +13,13 @@
 UtilityAudioProcessorEditor::UtilityAudioProcessorEditor(UtilityAudioProcessor& p)
     : AudioProcessorEditor(&p),
     audioProcessor(p),
+    goniometer(p.getMetering()),
+    meterPanel(p.getMetering(), p.getInputLoudness(), p.getOutputLoudness()),
+    dcButton([this](const juce::MouseEvent& e) { showDCButtonContextMenu(e); }),
     widthSlider([this](const juce::MouseEvent& e) { showWidthSliderContextMenu(e); }),
-    midSideSlider([this](const juce::MouseEvent& e) { showWidthSliderContextMenu(e); })
+    midSideSlider([this](const juce::MouseEvent& e) { showWidthSliderContextMenu(e); }),
+    bassCrossoverSlider([this](const juce::MouseEvent& e) { showBassCrossoverSliderContextMenu(e); }),
+    crossoverSpectrum(p.getMetering(), bassCrossoverSlider, p.apvts.getParameterRange("BassMonoCrossover"))
 { 
 #if ENABLE_INSPECTOR
     // open the inspector window
@@ -38,7 +43,7 @@ UtilityAudioProcessorEditor::UtilityAudioProcessorEditor(UtilityAudioProcessor&
 
     juce::LookAndFeel::getDefaultLookAndFeel().setDefaultSansSerifTypeface(Fonts::regular);
 
-    setSize(300, 430);
+    setSize(300, 430 + goniometerHeight + meterHeight);
 
     //float uiScale = 2.5;
     //setScaleFactor(uiScale);
@@ -162,6 +167,7 @@ UtilityAudioProcessorEditor::UtilityAudioProcessorEditor(UtilityAudioProcessor&
 
     addAndMakeVisible(gainSlider);
     addAndMakeVisible(balanceSlider);
+    addAndMakeVisible(crossoverSpectrum);
     addAndMakeVisible(bassCrossoverSlider);
     
     addChildComponent(midSideSlider);
@@ -175,6 +181,8 @@ UtilityAudioProcessorEditor::UtilityAudioProcessorEditor(UtilityAudioProcessor&
 
 
     addAndMakeVisible(modeComboBox);
+    addAndMakeVisible(goniometer);
+    addAndMakeVisible(meterPanel);
 
     addAndMakeVisible(inputLabel);
     addAndMakeVisible(outputLabel);
@@ -201,10 +209,20 @@ UtilityAudioProcessorEditor::UtilityAudioProcessorEditor(UtilityAudioProcessor&
     dcButtonAttachment = std::make_unique<ButtonAttachment>(audioProcessor.apvts, "DC", dcButton);
 
     midSideModeButtonAttachment = std::make_unique<ButtonAttachment>(audioProcessor.apvts, "MidSideMode", midSideModeButton);
+
+#if UTILITY_ENABLE_PROFILING
+    loadOverlay = std::make_unique<DspLoadOverlay>(audioProcessor.getProfiler());
+    addChildComponent(*loadOverlay);
+    goniometer.addMouseListener(this, false);
+#endif
 }
 
 UtilityAudioProcessorEditor::~UtilityAudioProcessorEditor()
 {
+#if UTILITY_ENABLE_PROFILING
+    goniometer.removeMouseListener(this);
+#endif
+
     widthSlider.setLookAndFeel(nullptr);
     gainSlider.setLookAndFeel(nullptr);
     balanceSlider.setLookAndFeel(nullptr);
@@ -227,7 +245,7 @@ UtilityAudioProcessorEditor::~UtilityAudioProcessorEditor()
 void UtilityAudioProcessorEditor::paint (juce::Graphics& g)
 {
     g.fillAll(juce::Colours::lightgrey);
-    auto bounds = getLocalBounds();
+    auto bounds = getLocalBounds().withTrimmedBottom(goniometerHeight + meterHeight);
     g.setColour(juce::Colours::grey.withAlpha(0.5f));
     g.drawVerticalLine(bounds.getWidth() / 2, bounds.getY() + 20, bounds.getBottom() - 20);
 }
@@ -236,6 +254,12 @@ void UtilityAudioProcessorEditor::resized()
 {
 
     auto area = getLocalBounds();
+    meterPanel.setBounds(area.removeFromBottom(meterHeight));
+    goniometer.setBounds(area.removeFromBottom(goniometerHeight).reduced(5));
+#if UTILITY_ENABLE_PROFILING
+    loadOverlay->setBounds(goniometer.getBounds());
+#endif
+
     auto left = area.withTrimmedRight(area.getWidth() / 2);
     auto right = area.withTrimmedLeft(area.getWidth() / 2);
 
@@ -269,6 +293,7 @@ void UtilityAudioProcessorEditor::resized()
     auto bxAndPWidth = bxAndPArea.getWidth() / 1.3;
 
     bassCrossoverSlider.setBounds(bxAndPArea.removeFromLeft(bxAndPWidth).reduced(padding));
+    crossoverSpectrum.setBounds(bassCrossoverSlider.getBounds());
     bassPreviewButton.setBounds(bxAndPArea.reduced(padding));
 
     outputLabel.setBounds(right.removeFromTop(itemHeight).reduced(itemMargin));
@@ -346,12 +371,30 @@ bool UtilityAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
     return false;
 }
 
+#if UTILITY_ENABLE_PROFILING
+void UtilityAudioProcessorEditor::mouseDown(const juce::MouseEvent& e)
+{
+    if (!e.mods.isPopupMenu())
+        return;
+
+    juce::PopupMenu menu;
+    menu.addItem(1, "Show DSP Load", true, loadOverlay->isVisible());
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetScreenArea(juce::Rectangle<int>(e.getScreenX(), e.getScreenY(), 1, 1)), [this](int result)
+    {
+        if (result == 1)
+            loadOverlay->setVisible(!loadOverlay->isVisible());
+    });
+}
+#endif
+
 void UtilityAudioProcessorEditor::onClickBassMono()
 {
     if (bassMonoButton.getToggleStateValue().toString() == "1")
     {
         bassCrossoverSlider.setAlpha(1.f);
         bassCrossoverSlider.setEnabled(true);
+        crossoverSpectrum.setAlpha(1.f);
 
         bassPreviewButton.setAlpha(1.f);
         bassPreviewButton.setEnabled(true);
@@ -361,6 +404,7 @@ void UtilityAudioProcessorEditor::onClickBassMono()
     {
         bassCrossoverSlider.setAlpha(0.3f);
         bassCrossoverSlider.setEnabled(false);
+        crossoverSpectrum.setAlpha(0.3f);
 
         bassPreviewButton.setAlpha(0.3f);
         bassPreviewButton.setEnabled(false);
@@ -379,7 +423,17 @@ void UtilityAudioProcessorEditor::showWidthSliderContextMenu(const juce::MouseEv
 
     midSideModePopupMenu.addItem(1, "Mid/Side Mode", true, midSideModeButton.getToggleState());
 
-    midSideModePopupMenu.showMenuAsync(juce::PopupMenu::Options().withTargetScreenArea(juce::Rectangle<int>(e.getScreenX(), e.getScreenY(), 1, 1)), [this](int result)
+    // Surround buses only: apply width/balance to every left/right pair or just the front one
+    auto* pairsParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("SurroundPairs"));
+    jassert(pairsParam);
+
+    if (audioProcessor.getTotalNumOutputChannels() > 2)
+    {
+        midSideModePopupMenu.addSeparator();
+        midSideModePopupMenu.addItem(2, "Front Pair Only", true, pairsParam->getIndex() == 1);
+    }
+
+    midSideModePopupMenu.showMenuAsync(juce::PopupMenu::Options().withTargetScreenArea(juce::Rectangle<int>(e.getScreenX(), e.getScreenY(), 1, 1)), [this, pairsParam](int result)
     {
         if (result == 1)
         {
@@ -387,5 +441,91 @@ void UtilityAudioProcessorEditor::showWidthSliderContextMenu(const juce::MouseEv
             DBG("Mid/Side Mode toggled to: " + juce::String(midSideModeButton.getToggleState() ? "ON" : "OFF"));
             updateWidthMidSideVisibility();
         }
+        else if (result == 2)
+        {
+            pairsParam->beginChangeGesture();
+            *pairsParam = pairsParam->getIndex() == 0 ? 1 : 0;
+            pairsParam->endChangeGesture();
+        }
     });
-}
\ No newline at end of file
+}
+
+void UtilityAudioProcessorEditor::showBassCrossoverSliderContextMenu(const juce::MouseEvent& e)
+{
+    auto* modeParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("BassMonoMode"));
+    jassert(modeParam);
+
+    juce::PopupMenu menu;
+    for (int i = 0; i < modeParam->choices.size(); ++i)
+    {
+        menu.addItem(i + 1, modeParam->choices[i] + " Mode", true, modeParam->getIndex() == i);
+    }
+
+    // Surround buses only: bass management into the LFE channel
+    auto* bassToLFEParam = dynamic_cast<juce::AudioParameterBool*>(audioProcessor.apvts.getParameter("BassToLFE"));
+    jassert(bassToLFEParam);
+
+    constexpr int bassToLFEItem = 100;
+
+    if (audioProcessor.getTotalNumOutputChannels() > 2)
+    {
+        menu.addSeparator();
+        menu.addItem(bassToLFEItem, "Route Bass To LFE", modeParam->getIndex() != UtilityParameters::linearPhaseBassMono, bassToLFEParam->get());
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetScreenArea(juce::Rectangle<int>(e.getScreenX(), e.getScreenY(), 1, 1)), [modeParam, bassToLFEParam](int result)
+    {
+        if (result == bassToLFEItem)
+        {
+            bassToLFEParam->beginChangeGesture();
+            *bassToLFEParam = !bassToLFEParam->get();
+            bassToLFEParam->endChangeGesture();
+        }
+        else if (result > 0)
+        {
+            modeParam->beginChangeGesture();
+            *modeParam = result - 1;
+            modeParam->endChangeGesture();
+            DBG("Bass Mono Mode set to: " + modeParam->getCurrentChoiceName());
+        }
+    });
+}
+
+void UtilityAudioProcessorEditor::showDCButtonContextMenu(const juce::MouseEvent& e)
+{
+    auto* cutoffParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("DCCutoff"));
+    jassert(cutoffParam);
+    auto* orderParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("DCOrder"));
+    jassert(orderParam);
+
+    // Cutoff items are index + 1, order items index + 100
+    constexpr int orderItemOffset = 100;
+
+    juce::PopupMenu menu;
+    for (int i = 0; i < cutoffParam->choices.size(); ++i)
+    {
+        menu.addItem(i + 1, cutoffParam->choices[i], true, cutoffParam->getIndex() == i);
+    }
+
+    menu.addSeparator();
+    for (int i = 0; i < orderParam->choices.size(); ++i)
+    {
+        menu.addItem(i + orderItemOffset, orderParam->choices[i], true, orderParam->getIndex() == i);
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetScreenArea(juce::Rectangle<int>(e.getScreenX(), e.getScreenY(), 1, 1)), [cutoffParam, orderParam](int result)
+    {
+        if (result >= orderItemOffset)
+        {
+            orderParam->beginChangeGesture();
+            *orderParam = result - orderItemOffset;
+            orderParam->endChangeGesture();
+        }
+        else if (result > 0)
+        {
+            cutoffParam->beginChangeGesture();
+            *cutoffParam = result - 1;
+            cutoffParam->endChangeGesture();
+        }
+    });
+}
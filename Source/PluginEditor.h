@@ -13,6 +13,11 @@
 #include "PluginProcessor.h"
 #include "CustomLookAndFeel.h"
 #include "ContextMenuSlider.h"
+#include "ContextMenuToggleButton.h"
+#include "MeterPanel.h"
+#include "Goniometer.h"
+#include "CrossoverSpectrum.h"
+#include "DspLoadOverlay.h"
 #include "Font.h"
 
 #if ENABLE_INSPECTOR
@@ -33,6 +38,11 @@ public:
 
     bool keyPressed(const juce::KeyPress& key) override;
 
+#if UTILITY_ENABLE_PROFILING
+    // Right-clicking the background or the goniometer shows or hides the DSP load overlay
+    void mouseDown(const juce::MouseEvent& e) override;
+#endif
+
 private:
 #if ENABLE_INSPECTOR
     melatonin::Inspector inspector{ *this };
@@ -40,11 +50,24 @@ private:
     void onClickBassMono();
 
     void showWidthSliderContextMenu(const juce::MouseEvent& e);
+    void showBassCrossoverSliderContextMenu(const juce::MouseEvent& e);
+    void showDCButtonContextMenu(const juce::MouseEvent& e);
 
     UtilityAudioProcessor& audioProcessor;
 
     CustomLookAndFeel lnf;
 
+    // Goniometer, then level, correlation and balance meters along the bottom
+    static constexpr int goniometerHeight = 150;
+    static constexpr int meterHeight = 117;
+    Goniometer goniometer;
+    MeterPanel meterPanel;
+
+#if UTILITY_ENABLE_PROFILING
+    // Over the goniometer, hidden until asked for
+    std::unique_ptr<DspLoadOverlay> loadOverlay;
+#endif
+
     juce::Label inputLabel, outputLabel;
     juce::Label widthLabel, balanceLabel, gainLabel, midSideLabel;
 
@@ -53,11 +76,15 @@ private:
         monoButton,
         bassMonoButton,
         bassPreviewButton,
-        muteButton,
-        dcButton;
+        muteButton;
+
+    ContextMenuToggleButton dcButton;
+
+    ContextMenuSlider widthSlider, midSideSlider, bassCrossoverSlider;
+    juce::Slider gainSlider, balanceSlider;
 
-    ContextMenuSlider widthSlider, midSideSlider;
-    juce::Slider gainSlider, balanceSlider, bassCrossoverSlider;
+    // Behind the crossover slider
+    CrossoverSpectrum crossoverSpectrum;
 
     juce::ComboBox modeComboBox;
 
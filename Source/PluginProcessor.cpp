@@ -7,7 +7,10 @@
 */
 
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+#if ! UTILITY_HEADLESS
+ #include "PluginEditor.h"
+#endif
+#include "AllocationGuard.h"
 
 
 //==============================================================================
@@ -65,7 +68,29 @@ UtilityAudioProcessor::UtilityAudioProcessor()
     midSideParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("MidSide"));
     jassert(midSideParam);
 
-    panner.setRule(juce::dsp::PannerRule::balanced);
+    bassMonoModeParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("BassMonoMode"));
+    jassert(bassMonoModeParam);
+
+    surroundPairsParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("SurroundPairs"));
+    jassert(surroundPairsParam);
+
+    bassToLFEParam = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter("BassToLFE"));
+    jassert(bassToLFEParam);
+
+    dcCutoffParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("DCCutoff"));
+    jassert(dcCutoffParam);
+
+    dcOrderParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("DCOrder"));
+    jassert(dcOrderParam);
+
+    // Picks the SIMD kernels now rather than on the audio thread
+    StereoKernels<float>::get();
+    StereoKernels<double>::get();
+
+#if UTILITY_ENABLE_PROFILING
+    floatEngine.setProfiler(&profiler);
+    doubleEngine.setProfiler(&profiler);
+#endif
 }
 
 UtilityAudioProcessor::~UtilityAudioProcessor()
@@ -105,6 +130,11 @@ bool UtilityAudioProcessor::isMidiEffect() const
    #endif
 }
 
+bool UtilityAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 double UtilityAudioProcessor::getTailLengthSeconds() const
 {
     return 0.0;
@@ -139,28 +169,32 @@ void UtilityAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
+    // The engines only ever see one tile at a time, whatever the host sends
+    tileSize = nextTileSize;
+
     juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
+    spec.maximumBlockSize = (juce::uint32)tileSize;
     spec.numChannels = getTotalNumOutputChannels();
     spec.sampleRate = sampleRate;
 
-    gain.prepare(spec);
-    gain.setRampDurationSeconds(0.03f);
-    gain.setGainDecibels(gainParam->get());
-
-    panner.prepare(spec);
-    panner.setPan(0.f);
+    updateLatency();
+    metering.prepare(sampleRate);
+#if !UTILITY_HEADLESS
+    inputLoudness.prepare(sampleRate);
+    outputLoudness.prepare(sampleRate);
+#endif
 
-    dcHighPassFilter.state = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 10);
-    dcHighPassFilter.prepare(spec);
+#if UTILITY_ENABLE_PROFILING
+    profiler.prepare(sampleRate, samplesPerBlock);
+#endif
 
-    HP.prepare(spec);
-    LP.prepare(spec);
+    auto layout = getChannelLayoutOfBus(false, 0);
 
-    HP.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-    HP.setCutoffFrequency(bassMonoCrossoverParam->get());
-    LP.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    LP.setCutoffFrequency(bassMonoCrossoverParam->get());
+    // Only the engine matching the host's processing precision is used
+    if (isUsingDoublePrecision())
+        doubleEngine.prepare(spec, layout, readParameters());
+    else
+        floatEngine.prepare(spec, layout, readParameters());
 }
 
 void UtilityAudioProcessor::releaseResources()
@@ -177,16 +211,27 @@ bool UtilityAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
+    // Mono, stereo and the common surround layouts; surround channels are
+    // processed in left/right pairs by the MultichannelEngine.
     // Some plugin hosts, such as certain GarageBand versions, will only
     // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    const auto& output = layouts.getMainOutputChannelSet();
+
+    if (output != juce::AudioChannelSet::mono()
+     && output != juce::AudioChannelSet::stereo()
+     && output != juce::AudioChannelSet::quadraphonic()
+     && output != juce::AudioChannelSet::create5point1()
+     && output != juce::AudioChannelSet::create7point1()
+     && output != juce::AudioChannelSet::create7point1point4())
         return false;
 
-    // This checks if the input layout matches the output layout
+    // This checks if the input layout matches the output layout, apart from
+    // mono in to stereo out
    #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    const auto& input = layouts.getMainInputChannelSet();
+
+    if (output != input
+     && !(input == juce::AudioChannelSet::mono() && output == juce::AudioChannelSet::stereo()))
         return false;
    #endif
 
@@ -195,47 +240,91 @@ bool UtilityAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 }
 #endif
 
-void makeMono(juce::AudioBuffer<float>& buffer, int numChannels)
+// Cutoffs of the "DCCutoff" choices
+static constexpr float dcCutoffs[] = { 2.f, 5.f, 10.f, 20.f };
+
+UtilityParameters UtilityAudioProcessor::readParameters() const
 {
-    if (numChannels >= 2)
-    {
-        auto* leftChannnel = buffer.getWritePointer(0);
-        auto* rightChannel = buffer.getWritePointer(1);
+    UtilityParameters parameters;
+
+    parameters.gainDecibels = gainParam->get();
+    parameters.balance = juce::jmap(balanceParam->get(), balanceMinRange, balanceMaxRange, -1.f, 1.f);
+    parameters.width = stereoWidthParam->get() * 0.01f;
+    parameters.midSide = midSideParam->get() * 0.01f;
+    parameters.bassMonoCrossover = bassMonoCrossoverParam->get();
+    parameters.mode = modeParam->getIndex();
+    parameters.bassMonoMode = bassMonoModeParam->getIndex();
+    parameters.midSideMode = midSideModeParam->get();
+    parameters.mute = muteParam->get();
+    parameters.dc = dcParam->get();
+    parameters.dcCutoff = dcCutoffs[(size_t)dcCutoffParam->getIndex()];
+    parameters.dcOrder = dcOrderParam->getIndex() + 1;
+    parameters.mono = monoParam->get();
+    parameters.bassMono = bassMonoParam->get();
+    parameters.bassMonoPreview = bassMonoPreviewParam->get();
+    parameters.invertLeft = invertPhaseLeftParam->get();
+    parameters.invertRight = invertPhaseRightParam->get();
+    parameters.allPairs = surroundPairsParam->getIndex() == 0;
+    parameters.bassToLFE = bassToLFEParam->get();
+
+    return parameters;
+}
 
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            float monoSample = (leftChannnel[sample] + rightChannel[sample]) * 0.5f;
-            leftChannnel[sample] = monoSample;
-            rightChannel[sample] = monoSample;
-        }
-    }
+void UtilityAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    process(buffer, floatEngine);
 }
 
-void muteChannel(juce::AudioBuffer<float>& buffer, int channel)
+void UtilityAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
 {
-    jassert(channel == 0 || channel == 1);
-    auto* chPtr = buffer.getWritePointer(channel);
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-    {
-        chPtr[sample] = 0.f;
-    }
+    process(buffer, doubleEngine);
 }
 
-void swapChannels(juce::AudioBuffer<float>& buffer)
+bool UtilityAudioProcessor::isReadyToRender() const
 {
-    jassert(buffer.getNumChannels() == 2);
-    auto* left = buffer.getWritePointer(0);
-    auto* right = buffer.getWritePointer(1);
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-    {
-        float tmp = left[sample];
-        left[sample] = right[sample];
-        right[sample] = tmp;
-    }
+    const auto parameters = readParameters();
+    return isUsingDoublePrecision() ? doubleEngine.isReady(parameters) : floatEngine.isReady(parameters);
 }
 
-void UtilityAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+int UtilityAudioProcessor::getWarmUpSamples() const
+{
+    return UtilityEngine<float>::getWarmUpSamples(readParameters(), getSampleRate());
+}
+
+void UtilityAudioProcessor::setTileSize(int newTileSize)
 {
+    jassert(juce::isPowerOfTwo(newTileSize) && newTileSize >= minimumTileSize && newTileSize <= maximumTileSize);
+    nextTileSize = juce::jlimit(minimumTileSize, maximumTileSize, juce::nextPowerOfTwo(newTileSize));
+}
+
+void UtilityAudioProcessor::updateLatency()
+{
+    // Every channel is delayed by the same amount in the linear phase mode,
+    // whether bass mono is on or not, so toggling it doesn't shift the audio.
+    const auto latency = bassMonoModeParam->getIndex() == UtilityParameters::linearPhaseBassMono
+                       ? UtilityEngine<float>::getLinearPhaseLatencySamples(getSampleRate())
+                       : 0;
+
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+template <typename SampleType>
+void UtilityAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer, MultichannelEngine<SampleType>& engine)
+{
+#if UTILITY_ENABLE_PROFILING
+    profiler.beginBlock();
+#endif
+
+    // Ahead of the allocation guard: the wrapper may allocate to tell the host,
+    // and the linear phase filters register with their background thread the
+    // first time they are needed
+    updateLatency();
+
+    if (bassMonoParam->get() && bassMonoModeParam->getIndex() == UtilityParameters::linearPhaseBassMono)
+        engine.activateLinearPhase();
+
+    ScopedAllocationGuard allocationGuard;
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -249,175 +338,74 @@ void UtilityAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    //for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    //{
-    //    auto* channelData = buffer.getWritePointer (channel);
-
-    //    // ..do something to the data...
-    //}
+    // The meters, loudness included, only run while the editor shows them
+    const auto metered = metering.isEnabled();
 
-    // inv L inv R
-
-    if (invertPhaseLeftParam->get())
+    // Parameters are read at the start of every tile. This picks up changes
+    // made from the editor or another thread during a large block, but isn't
+    // sample-accurate host automation: the plugin wrappers of this JUCE
+    // version apply a block's parameter changes before processBlock() is
+    // called, and don't pass on where in the block they fall. The tiles refer
+    // to the host buffer's memory, nothing is copied.
+    for (int start = 0; start < buffer.getNumSamples(); start += tileSize)
     {
-        auto* leftChannel = buffer.getWritePointer(0);
-
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            leftChannel[sample] = leftChannel[sample] * -1.f;
-        }
-    }
+        const auto numSamples = juce::jmin(tileSize, buffer.getNumSamples() - start);
+        juce::AudioBuffer<SampleType> tile(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
 
-    if (invertPhaseRightParam->get())
-    {
-        auto* rightChannel = buffer.getWritePointer(1);
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        if (metered)
         {
-            rightChannel[sample] = rightChannel[sample] * -1.f;
+            UTILITY_PROFILE_STAGE(&profiler, meteringStage);
+#if !UTILITY_HEADLESS
+            inputLoudness.process(tile, totalNumInputChannels);
+#endif
+            metering.measureInput(tile, totalNumInputChannels);
         }
-    }
 
-    // Mode
+        const auto result = engine.process(tile, totalNumInputChannels, readParameters());
 
-    switch (modeParam->getIndex())
-    {
-    case 0: // stereo
-        break;
-    case 1: // left
-        muteChannel(buffer, 1);
-        break;
-    case 2: // right
-        muteChannel(buffer, 0);
-        break;
-    case 3: // swap
-        swapChannels(buffer);
-        break;
-    }
-
-    // Stereo Width / MidSide balance
-
-
-    if (totalNumInputChannels == 2)
-    {
-        auto* leftChannel = buffer.getWritePointer(0);
-        auto* rightChannel = buffer.getWritePointer(1);
-
-        if (midSideModeParam->get())
-        {
-            float midSideBalance = midSideParam->get() * 0.01f;
-
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float mid = (leftChannel[sample] + rightChannel[sample]) * 0.5f;
-                float side = (leftChannel[sample] - rightChannel[sample]) * 0.5f;
-
-                mid *= (1.0f - midSideBalance);
-                side *= (1.0f + midSideBalance);
-
-                leftChannel[sample] = mid + side;
-                rightChannel[sample] = mid - side;
-            }
-        }
-        else
+        if (metered)
         {
-            float width = stereoWidthParam->get() * 0.01f;
-
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float mid = (leftChannel[sample] + rightChannel[sample]) * 0.5f;
-                float side = (leftChannel[sample] - rightChannel[sample]) * 0.5f;
-
-                side *= width;
-
-                leftChannel[sample] = mid + side;
-                rightChannel[sample] = mid - side;
-            }
+            UTILITY_PROFILE_STAGE(&profiler, meteringStage);
+#if !UTILITY_HEADLESS
+            // The engine's fast paths skip the loudness filters too: an
+            // unchanged output measures what the input did, a muted one is silence
+            const auto numOutputChannels = tile.getNumChannels();
+
+            if (result == TileResult::silent)
+                outputLoudness.processSilence(numSamples);
+            else if (result == TileResult::unchanged && juce::jmin(totalNumInputChannels, 2) == juce::jmin(numOutputChannels, 2))
+                outputLoudness.processUnchanged(tile, numOutputChannels, inputLoudness);
+            else
+                outputLoudness.process(tile, numOutputChannels);
+#else
+            juce::ignoreUnused(result);
+#endif
+            metering.measureOutput(tile);
         }
     }
 
-    // Mono
-
-    if (monoParam->get())
-    {
-        makeMono(buffer, totalNumInputChannels);
-    }
-
-    // Bass Mono Crossover
-
-    if (bassMonoParam->get())
-    {
-        HP.setCutoffFrequency(bassMonoCrossoverParam->get());
-        LP.setCutoffFrequency(bassMonoCrossoverParam->get());
-        hpBuffer.makeCopyOf(buffer);
-
-        makeMono(buffer, totalNumInputChannels);
-
-        lpBuffer.makeCopyOf(buffer);
-        juce::dsp::AudioBlock<float> hpBlock = juce::dsp::AudioBlock<float>(hpBuffer);
-        juce::dsp::AudioBlock<float> lpBlock = juce::dsp::AudioBlock<float>(lpBuffer);
-        auto hpCtx = juce::dsp::ProcessContextReplacing<float>(hpBlock);
-        auto lpCtx = juce::dsp::ProcessContextReplacing<float>(lpBlock);
-
-        HP.process(hpCtx);
-        LP.process(lpCtx);
-
-        for (auto i = 0; i < buffer.getNumChannels(); i++)
-        {
-            buffer.clear(i, 0, buffer.getNumSamples());
-            if (!bassMonoPreviewParam->get())
-            {
-                buffer.addFrom(i, 0, hpBuffer, i, 0, buffer.getNumSamples());
-            }
-            buffer.addFrom(i, 0, lpBuffer, i, 0, buffer.getNumSamples());
-        }   
-    }
-
-    //if (bassMonoPreviewParam->get())
-    //{
-    //    hpBuffer.clear();
-    //}
+    if (metered)
+        metering.finishBlock();
 
-    auto block = juce::dsp::AudioBlock<float>(buffer);
-    auto ctx = juce::dsp::ProcessContextReplacing<float>(block);
-
-    // Gain
-    gain.setGainDecibels(gainParam->get());
-    gain.process(ctx);
-
-    // Balance
-    panner.setPan(juce::jmap(balanceParam->get(), balanceMinRange, balanceMaxRange, -1.f, 1.f));
-    panner.process(ctx);
-
-    // Mute
-    if (muteParam->get())
-    {
-        buffer.clear();
-        return;
-    }
-
-    // Remove DC
-    if (dcParam->get())
-    {
-        dcHighPassFilter.process(ctx);
-    }
+#if UTILITY_ENABLE_PROFILING
+    profiler.endBlock(buffer.getNumSamples());
+#endif
 }
 
 //==============================================================================
 bool UtilityAudioProcessor::hasEditor() const
 {
-    return true; // (change this to false if you choose to not supply an editor)
+    return ! UTILITY_HEADLESS; // (change this to false if you choose to not supply an editor)
 }
 
 juce::AudioProcessorEditor* UtilityAudioProcessor::createEditor()
 {
+   #if UTILITY_HEADLESS
+    return nullptr;
+   #else
     return new UtilityAudioProcessorEditor (*this);
     //return new juce::GenericAudioProcessorEditor(*this);
+   #endif
 }
 
 //==============================================================================
@@ -508,6 +496,11 @@ juce::AudioProcessorValueTreeState::ParameterLayout UtilityAudioProcessor::creat
 	layout.add(std::make_unique<juce::AudioParameterChoice>("Mode", "Mode", juce::StringArray{ "Stereo", "Left", "Right", "Swap", }, 0));
     layout.add(std::make_unique<juce::AudioParameterBool>("MidSideMode", "Mid/Side Mode", false));
     layout.add(std::make_unique<juce::AudioParameterFloat>("MidSide", "Mid/Side", juce::NormalisableRange<float>(-100.f, 100.f, 1.0f, 1.0f), 0.f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("BassMonoMode", "Bass Mono Mode", juce::StringArray{ "Crossover", "Side", "Linear Phase" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("SurroundPairs", "Surround Pairs", juce::StringArray{ "All", "Front" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterBool>("BassToLFE", "Bass To LFE", false));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("DCCutoff", "DC Cutoff", juce::StringArray{ "2 Hz", "5 Hz", "10 Hz", "20 Hz" }, 2));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("DCOrder", "DC Order", juce::StringArray{ "1st Order", "2nd Order" }, 1));
 
     return layout;
 }
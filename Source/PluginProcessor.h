@@ -9,6 +9,22 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MultichannelEngine.h"
+#include "Metering.h"
+#include "LoudnessMeter.h"
+#include "DspProfiler.h"
+
+// Default samples per processing tile, see UtilityAudioProcessor::setTileSize().
+// Larger tiles spend less on per-tile setup; the benchmark's tile size sweep
+// levels off at about 128.
+#ifndef UTILITY_TILE_SIZE
+ #define UTILITY_TILE_SIZE 128
+#endif
+
+// Builds the processor without its editor, for the offline render tool
+#ifndef UTILITY_HEADLESS
+ #define UTILITY_HEADLESS 0
+#endif
 
 //==============================================================================
 /**
@@ -29,6 +45,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -60,20 +78,82 @@ private:
 public:
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout() };
 
+    // For offline rendering: false until state that is built in the background
+    // for the current parameters (the linear phase filter's kernel) has
+    // arrived. It arrives during processBlock(), so process silence until this
+    // returns true.
+    bool isReadyToRender() const;
+
+    // For rendering in chunks: how far ahead of a chunk to start feeding input
+    // for its output to match a render from the start, with the current
+    // parameters and sample rate. See UtilityEngine::getWarmUpSamples().
+    int getWarmUpSamples() const;
+
+    // Host buffers are processed in tiles of at most this many samples: every
+    // enabled stage runs over a tile while it is still in cache, and parameters
+    // are read once per tile (see process() for what that does and doesn't
+    // give automation). The engines never see more than one tile, so host
+    // blocks larger than announced in prepareToPlay are fine.
+    // A power of two from minimumTileSize to maximumTileSize, UTILITY_TILE_SIZE
+    // by default. Takes effect at the next prepareToPlay(), for benchmarks.
+    void setTileSize(int newTileSize);
+    // The one in use since the last prepareToPlay()
+    int getTileSize() const { return tileSize; }
+
+    static constexpr int minimumTileSize = 16;
+    static constexpr int maximumTileSize = 1024;
+
+    // Input and output levels for the editor's meters
+    Metering& getMetering() { return metering; }
+
+#if !UTILITY_HEADLESS
+    // Measured, like the other meters, only while the editor is open: integrated
+    // loudness and loudness range cover the time it was shown
+    LoudnessMeter& getInputLoudness() { return inputLoudness; }
+    LoudnessMeter& getOutputLoudness() { return outputLoudness; }
+#endif
+
+#if UTILITY_ENABLE_PROFILING
+    // Processing time against the real-time budget, for the editor's load overlay
+    DspProfiler& getProfiler() { return profiler; }
+#endif
+
 private:
-    juce::dsp::Gain<float> gain;
-    juce::dsp::Panner<float> panner;
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> dcHighPassFilter;
-    juce::dsp::LinkwitzRileyFilter<float> HP, LP;
+    static_assert(juce::isPowerOfTwo(UTILITY_TILE_SIZE) && UTILITY_TILE_SIZE >= minimumTileSize && UTILITY_TILE_SIZE <= maximumTileSize,
+                  "UTILITY_TILE_SIZE must be a power of two in [16, 1024]");
+
+    // The one the engines were prepared for, and the next one
+    int tileSize = UTILITY_TILE_SIZE;
+    int nextTileSize = UTILITY_TILE_SIZE;
+
+    // Current values of all parameters, for one tile
+    UtilityParameters readParameters() const;
+
+    template <typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer, MultichannelEngine<SampleType>& engine);
+
+    // Reports the latency of the linear phase bass mono mode while it is selected
+    void updateLatency();
+
+    MultichannelEngine<float> floatEngine;
+    MultichannelEngine<double> doubleEngine;
+
+    Metering metering;
+#if !UTILITY_HEADLESS
+    LoudnessMeter inputLoudness, outputLoudness;
+#endif
 
-    juce::AudioBuffer<float> hpBuffer;
-    juce::AudioBuffer<float> lpBuffer;
+#if UTILITY_ENABLE_PROFILING
+    DspProfiler profiler;
+#endif
 
     juce::AudioParameterFloat* gainParam{ nullptr };
     juce::AudioParameterFloat* balanceParam{ nullptr };
     juce::AudioParameterFloat* stereoWidthParam{ nullptr };
     juce::AudioParameterBool* muteParam{ nullptr };
     juce::AudioParameterBool* dcParam{ nullptr };
+    juce::AudioParameterChoice* dcCutoffParam{ nullptr };
+    juce::AudioParameterChoice* dcOrderParam{ nullptr };
     juce::AudioParameterBool* monoParam{ nullptr };
     juce::AudioParameterBool* bassMonoParam{ nullptr };
     juce::AudioParameterFloat* bassMonoCrossoverParam{ nullptr };
@@ -83,6 +163,9 @@ private:
     juce::AudioParameterChoice* modeParam{ nullptr };
     juce::AudioParameterBool* midSideModeParam{ nullptr };
     juce::AudioParameterFloat* midSideParam{ nullptr };
+    juce::AudioParameterChoice* bassMonoModeParam{ nullptr };
+    juce::AudioParameterChoice* surroundPairsParam{ nullptr };
+    juce::AudioParameterBool* bassToLFEParam{ nullptr };
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UtilityAudioProcessor)
@@ -0,0 +1,128 @@
+#include "SpectrumAnalyser.h"
+
+
+SpectrumAnalyser::SpectrumAnalyser(Metering& m, std::vector<float> bandFrequencies)
+    : metering(m),
+      frequencies(std::move(bandFrequencies)),
+      incoming((size_t)Metering::analyserFifoSize)
+{
+    for (auto* spectrum : { &smoothed, &latest })
+    {
+        spectrum->mid.assign(frequencies.size(), minDecibels);
+        spectrum->side.assign(frequencies.size(), minDecibels);
+    }
+
+    // Anything left over from an earlier editor is stale
+    metering.readAnalyserSamples(incoming.data(), (int)incoming.size());
+
+    metering.addViewer();
+    workerThread->thread.addTimeSliceClient(this);
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    // Waits for a frame that is being analysed right now
+    workerThread->thread.removeTimeSliceClient(this);
+    metering.removeViewer();
+}
+
+void SpectrumAnalyser::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    // Bins of about 6 Hz at any sample rate, for the bass crossover range
+    const auto order = juce::jlimit(12, 15, 13 + juce::roundToInt(std::log2(sampleRate / 48000.0)));
+    fft = std::make_unique<juce::dsp::FFT>(order);
+
+    const auto size = (size_t)fft->getSize();
+    window.resize(size);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), size, juce::dsp::WindowingFunction<float>::hann, false);
+    windowSum = std::accumulate(window.begin(), window.end(), 0.f);
+
+    fftData.assign(2 * size, 0.f);
+    midHistory.assign(size, 0.f);
+    sideHistory.assign(size, 0.f);
+}
+
+int SpectrumAnalyser::useTimeSlice()
+{
+    constexpr int frameInterval = 1000 / maxFrameRate;
+
+    if (metering.getSampleRate() != sampleRate)
+        prepare(metering.getSampleRate());
+
+    const auto numNewSamples = metering.readAnalyserSamples(incoming.data(), (int)incoming.size());
+
+    // Nothing playing (or the FIFO was drained by a frame that took too long): keep the last spectrum
+    if (numNewSamples == 0)
+        return frameInterval;
+
+    appendToHistory(midHistory, numNewSamples, &MidSideSample::mid);
+    appendToHistory(sideHistory, numNewSamples, &MidSideSample::side);
+
+    analyse(midHistory, smoothed.mid);
+    analyse(sideHistory, smoothed.side);
+
+    {
+        const juce::SpinLock::ScopedLockType lock(latestLock);
+        latest.mid = smoothed.mid;
+        latest.side = smoothed.side;
+        latestIsNew = true;
+    }
+
+    return frameInterval;
+}
+
+void SpectrumAnalyser::appendToHistory(std::vector<float>& history, int numNewSamples, float MidSideSample::* channel)
+{
+    const auto size = (int)history.size();
+    const auto numToAppend = juce::jmin(numNewSamples, size);
+    const auto numToKeep = size - numToAppend;
+
+    std::copy(history.end() - numToKeep, history.end(), history.begin());
+
+    const auto* source = incoming.data() + numNewSamples - numToAppend;
+
+    for (int i = 0; i < numToAppend; ++i)
+        history[(size_t)(numToKeep + i)] = source[i].*channel;
+}
+
+void SpectrumAnalyser::analyse(const std::vector<float>& history, std::vector<float>& levels)
+{
+    const auto size = history.size();
+    juce::FloatVectorOperations::multiply(fftData.data(), history.data(), window.data(), (int)size);
+    std::fill(fftData.begin() + (std::ptrdiff_t)size, fftData.end(), 0.f);
+
+    fft->performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+    // A full scale sine reads 0 dB
+    const auto scale = 2.f / windowSum;
+    const auto binsPerHz = (float)((double)size / sampleRate);
+    const auto lastBin = (int)size / 2;
+
+    for (size_t band = 0; band < frequencies.size(); ++band)
+    {
+        const auto position = frequencies[band] * binsPerHz;
+        const auto bin = juce::jmin((int)position, lastBin - 1);
+        const auto fraction = position - (float)bin;
+        const auto magnitude = fftData[(size_t)bin] + fraction * (fftData[(size_t)bin + 1] - fftData[(size_t)bin]);
+        const auto level = juce::Decibels::gainToDecibels(magnitude * scale, minDecibels);
+
+        auto& current = levels[band];
+        current = level > current ? level : current + releasePerFrame * (level - current);
+    }
+}
+
+bool SpectrumAnalyser::getLatest(Spectrum& spectrum)
+{
+    const juce::SpinLock::ScopedLockType lock(latestLock);
+
+    if (!latestIsNew)
+        return false;
+
+    spectrum.mid = latest.mid;
+    spectrum.side = latest.side;
+    latestIsNew = false;
+
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Metering.h"
+
+
+// Mid and side spectra of the output at a fixed set of frequencies.
+//
+// The audio thread only copies samples into Metering's analyser FIFO. The
+// windowing, FFTs and smoothing run on a background thread shared by every
+// open analyser, at most maxFrameRate times a second; the editor picks up
+// the newest result from its own timer. The thread stops once the last
+// analyser is gone.
+class SpectrumAnalyser : private juce::TimeSliceClient
+{
+public:
+    SpectrumAnalyser(Metering& metering, std::vector<float> bandFrequencies);
+    ~SpectrumAnalyser() override;
+
+    // Smoothed levels in dB at each band frequency
+    struct Spectrum
+    {
+        std::vector<float> mid, side;
+    };
+
+    // Copies the newest spectrum, returns false if there's none since the last call
+    bool getLatest(Spectrum& spectrum);
+
+    static constexpr float minDecibels = -90.f;
+
+private:
+    int useTimeSlice() override;
+
+    void prepare(double newSampleRate);
+    void appendToHistory(std::vector<float>& history, int numNewSamples, float MidSideSample::* channel);
+    void analyse(const std::vector<float>& history, std::vector<float>& levels);
+
+    static constexpr int maxFrameRate = 20;
+    // Share of a falling level's distance to the new one covered per frame; rises are immediate
+    static constexpr float releasePerFrame = 0.25f;
+
+    struct WorkerThread
+    {
+        WorkerThread() { thread.startThread(); }
+        ~WorkerThread() { thread.stopThread(1000); }
+
+        juce::TimeSliceThread thread{ "Spectrum Analyser" };
+    };
+
+    juce::SharedResourcePointer<WorkerThread> workerThread;
+
+    Metering& metering;
+    const std::vector<float> frequencies;
+
+    // Worker thread only
+    double sampleRate = 0;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> window, fftData;
+    float windowSum = 1.f;
+    std::vector<MidSideSample> incoming;
+    // The last FFT size samples of each signal, oldest first
+    std::vector<float> midHistory, sideHistory;
+    Spectrum smoothed;
+
+    juce::SpinLock latestLock;
+    Spectrum latest;
+    bool latestIsNew = false;
+};
@@ -0,0 +1,466 @@
+#include "StereoKernels.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <cpuid.h>
+ #endif
+#endif
+
+// Lets GCC and Clang compile a function for an instruction set the rest of the
+// binary doesn't assume. MSVC accepts the intrinsics without it.
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG)
+ #define UTILITY_TARGET(isa) __attribute__((target(isa)))
+#else
+ #define UTILITY_TARGET(isa)
+#endif
+
+
+namespace scalar
+{
+    template <typename SampleType>
+    void applyMatrix(SampleType* left, SampleType* right, int numSamples, SampleType ll, SampleType lr, SampleType rl, SampleType rr)
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const auto l = left[sample];
+            const auto r = right[sample];
+
+            left[sample] = ll * l + lr * r;
+            right[sample] = rl * l + rr * r;
+        }
+    }
+
+    template <typename SampleType>
+    void applyGains(SampleType* left, SampleType* right, int numSamples, SampleType leftGain, SampleType rightGain)
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            left[sample] *= leftGain;
+            right[sample] *= rightGain;
+        }
+    }
+
+    template <typename SampleType>
+    void sumProducts(const SampleType* left, const SampleType* right, int numSamples, SampleType* sums)
+    {
+        SampleType leftSquares = 0, rightSquares = 0, products = 0;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            leftSquares += left[sample] * left[sample];
+            rightSquares += right[sample] * right[sample];
+            products += left[sample] * right[sample];
+        }
+
+        sums[0] += leftSquares;
+        sums[1] += rightSquares;
+        sums[2] += products;
+    }
+}
+
+#if JUCE_INTEL
+
+namespace sse2
+{
+    UTILITY_TARGET("sse2") inline __m128 load(const float* p) { return _mm_loadu_ps(p); }
+    UTILITY_TARGET("sse2") inline __m128d load(const double* p) { return _mm_loadu_pd(p); }
+    UTILITY_TARGET("sse2") inline void store(float* p, __m128 v) { _mm_storeu_ps(p, v); }
+    UTILITY_TARGET("sse2") inline void store(double* p, __m128d v) { _mm_storeu_pd(p, v); }
+    UTILITY_TARGET("sse2") inline __m128 broadcast(float x) { return _mm_set1_ps(x); }
+    UTILITY_TARGET("sse2") inline __m128d broadcast(double x) { return _mm_set1_pd(x); }
+    UTILITY_TARGET("sse2") inline __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+    UTILITY_TARGET("sse2") inline __m128d mul(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+    // No FMA before AVX2
+    UTILITY_TARGET("sse2") inline __m128 mulAdd(__m128 a, __m128 b, __m128 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    UTILITY_TARGET("sse2") inline __m128d mulAdd(__m128d a, __m128d b, __m128d c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+
+    template <typename SampleType>
+    UTILITY_TARGET("sse2") void applyMatrix(SampleType* left, SampleType* right, int numSamples, SampleType ll, SampleType lr, SampleType rl, SampleType rr)
+    {
+        constexpr int lanes = 16 / (int)sizeof(SampleType);
+        const auto vll = broadcast(ll), vlr = broadcast(lr), vrl = broadcast(rl), vrr = broadcast(rr);
+        int sample = 0;
+
+        for (; sample + lanes <= numSamples; sample += lanes)
+        {
+            const auto l = load(left + sample);
+            const auto r = load(right + sample);
+            store(left + sample, mulAdd(vll, l, mul(vlr, r)));
+            store(right + sample, mulAdd(vrl, l, mul(vrr, r)));
+        }
+
+        scalar::applyMatrix(left + sample, right + sample, numSamples - sample, ll, lr, rl, rr);
+    }
+
+    template <typename SampleType>
+    UTILITY_TARGET("sse2") void applyGains(SampleType* left, SampleType* right, int numSamples, SampleType leftGain, SampleType rightGain)
+    {
+        constexpr int lanes = 16 / (int)sizeof(SampleType);
+        const auto vl = broadcast(leftGain), vr = broadcast(rightGain);
+        int sample = 0;
+
+        for (; sample + lanes <= numSamples; sample += lanes)
+        {
+            store(left + sample, mul(vl, load(left + sample)));
+            store(right + sample, mul(vr, load(right + sample)));
+        }
+
+        scalar::applyGains(left + sample, right + sample, numSamples - sample, leftGain, rightGain);
+    }
+
+    template <typename SampleType>
+    UTILITY_TARGET("sse2") void sumProducts(const SampleType* left, const SampleType* right, int numSamples, SampleType* sums)
+    {
+        constexpr int lanes = 16 / (int)sizeof(SampleType);
+        auto leftSquares = broadcast(SampleType(0)), rightSquares = leftSquares, products = leftSquares;
+        int sample = 0;
+
+        for (; sample + lanes <= numSamples; sample += lanes)
+        {
+            const auto l = load(left + sample);
+            const auto r = load(right + sample);
+            leftSquares = mulAdd(l, l, leftSquares);
+            rightSquares = mulAdd(r, r, rightSquares);
+            products = mulAdd(l, r, products);
+        }
+
+        SampleType partialSums[lanes];
+
+        for (auto [vector, sum] : { std::pair(leftSquares, sums), std::pair(rightSquares, sums + 1), std::pair(products, sums + 2) })
+        {
+            store(partialSums, vector);
+
+            for (auto partialSum : partialSums)
+                *sum += partialSum;
+        }
+
+        scalar::sumProducts(left + sample, right + sample, numSamples - sample, sums);
+    }
+}
+
+namespace avx2
+{
+    UTILITY_TARGET("avx2,fma") inline __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+    UTILITY_TARGET("avx2,fma") inline __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+    UTILITY_TARGET("avx2,fma") inline void store(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+    UTILITY_TARGET("avx2,fma") inline void store(double* p, __m256d v) { _mm256_storeu_pd(p, v); }
+    UTILITY_TARGET("avx2,fma") inline __m256 broadcast(float x) { return _mm256_set1_ps(x); }
+    UTILITY_TARGET("avx2,fma") inline __m256d broadcast(double x) { return _mm256_set1_pd(x); }
+    UTILITY_TARGET("avx2,fma") inline __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+    UTILITY_TARGET("avx2,fma") inline __m256d mul(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+    UTILITY_TARGET("avx2,fma") inline __m256 mulAdd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+    UTILITY_TARGET("avx2,fma") inline __m256d mulAdd(__m256d a, __m256d b, __m256d c) { return _mm256_fmadd_pd(a, b, c); }
+
+    template <typename SampleType>
+    UTILITY_TARGET("avx2,fma") void applyMatrix(SampleType* left, SampleType* right, int numSamples, SampleType ll, SampleType lr, SampleType rl, SampleType rr)
+    {
+        constexpr int lanes = 32 / (int)sizeof(SampleType);
+        const auto vll = broadcast(ll), vlr = broadcast(lr), vrl = broadcast(rl), vrr = broadcast(rr);
+        int sample = 0;
+
+        for (; sample + lanes <= numSamples; sample += lanes)
+        {
+            const auto l = load(left + sample);
+            const auto r = load(right + sample);
+            store(left + sample, mulAdd(vll, l, mul(vlr, r)));
+            store(right + sample, mulAdd(vrl, l, mul(vrr, r)));
+        }
+
+        scalar::applyMatrix(left + sample, right + sample, numSamples - sample, ll, lr, rl, rr);
+    }
+
+    template <typename SampleType>
+    UTILITY_TARGET("avx2,fma") void applyGains(SampleType* left, SampleType* right, int numSamples, SampleType leftGain, SampleType rightGain)
+    {
+        constexpr int lanes = 32 / (int)sizeof(SampleType);
+        const auto vl = broadcast(leftGain), vr = broadcast(rightGain);
+        int sample = 0;
+
+        for (; sample + lanes <= numSamples; sample += lanes)
+        {
+            store(left + sample, mul(vl, load(left + sample)));
+            store(right + sample, mul(vr, load(right + sample)));
+        }
+
+        scalar::applyGains(left + sample, right + sample, numSamples - sample, leftGain, rightGain);
+    }
+
+    template <typename SampleType>
+    UTILITY_TARGET("avx2,fma") void sumProducts(const SampleType* left, const SampleType* right, int numSamples, SampleType* sums)
+    {
+        constexpr int lanes = 32 / (int)sizeof(SampleType);
+        auto leftSquares = broadcast(SampleType(0)), rightSquares = leftSquares, products = leftSquares;
+        int sample = 0;
+
+        for (; sample + lanes <= numSamples; sample += lanes)
+        {
+            const auto l = load(left + sample);
+            const auto r = load(right + sample);
+            leftSquares = mulAdd(l, l, leftSquares);
+            rightSquares = mulAdd(r, r, rightSquares);
+            products = mulAdd(l, r, products);
+        }
+
+        SampleType partialSums[lanes];
+
+        for (auto [vector, sum] : { std::pair(leftSquares, sums), std::pair(rightSquares, sums + 1), std::pair(products, sums + 2) })
+        {
+            store(partialSums, vector);
+
+            for (auto partialSum : partialSums)
+                *sum += partialSum;
+        }
+
+        scalar::sumProducts(left + sample, right + sample, numSamples - sample, sums);
+    }
+}
+
+namespace avx512
+{
+    UTILITY_TARGET("avx512f") inline __m512 load(const float* p) { return _mm512_loadu_ps(p); }
+    UTILITY_TARGET("avx512f") inline __m512d load(const double* p) { return _mm512_loadu_pd(p); }
+    UTILITY_TARGET("avx512f") inline void store(float* p, __m512 v) { _mm512_storeu_ps(p, v); }
+    UTILITY_TARGET("avx512f") inline void store(double* p, __m512d v) { _mm512_storeu_pd(p, v); }
+    UTILITY_TARGET("avx512f") inline __m512 broadcast(float x) { return _mm512_set1_ps(x); }
+    UTILITY_TARGET("avx512f") inline __m512d broadcast(double x) { return _mm512_set1_pd(x); }
+    UTILITY_TARGET("avx512f") inline __m512 mul(__m512 a, __m512 b) { return _mm512_mul_ps(a, b); }
+    UTILITY_TARGET("avx512f") inline __m512d mul(__m512d a, __m512d b) { return _mm512_mul_pd(a, b); }
+    UTILITY_TARGET("avx512f") inline __m512 mulAdd(__m512 a, __m512 b, __m512 c) { return _mm512_fmadd_ps(a, b, c); }
+    UTILITY_TARGET("avx512f") inline __m512d mulAdd(__m512d a, __m512d b, __m512d c) { return _mm512_fmadd_pd(a, b, c); }
+
+    template <typename SampleType>
+    UTILITY_TARGET("avx512f") void applyMatrix(SampleType* left, SampleType* right, int numSamples, SampleType ll, SampleType lr, SampleType rl, SampleType rr)
+    {
+        constexpr int lanes = 64 / (int)sizeof(SampleType);
+        const auto vll = broadcast(ll), vlr = broadcast(lr), vrl = broadcast(rl), vrr = broadcast(rr);
+        int sample = 0;
+
+        for (; sample + lanes <= numSamples; sample += lanes)
+        {
+            const auto l = load(left + sample);
+            const auto r = load(right + sample);
+            store(left + sample, mulAdd(vll, l, mul(vlr, r)));
+            store(right + sample, mulAdd(vrl, l, mul(vrr, r)));
+        }
+
+        scalar::applyMatrix(left + sample, right + sample, numSamples - sample, ll, lr, rl, rr);
+    }
+
+    template <typename SampleType>
+    UTILITY_TARGET("avx512f") void applyGains(SampleType* left, SampleType* right, int numSamples, SampleType leftGain, SampleType rightGain)
+    {
+        constexpr int lanes = 64 / (int)sizeof(SampleType);
+        const auto vl = broadcast(leftGain), vr = broadcast(rightGain);
+        int sample = 0;
+
+        for (; sample + lanes <= numSamples; sample += lanes)
+        {
+            store(left + sample, mul(vl, load(left + sample)));
+            store(right + sample, mul(vr, load(right + sample)));
+        }
+
+        scalar::applyGains(left + sample, right + sample, numSamples - sample, leftGain, rightGain);
+    }
+
+    template <typename SampleType>
+    UTILITY_TARGET("avx512f") void sumProducts(const SampleType* left, const SampleType* right, int numSamples, SampleType* sums)
+    {
+        constexpr int lanes = 64 / (int)sizeof(SampleType);
+        auto leftSquares = broadcast(SampleType(0)), rightSquares = leftSquares, products = leftSquares;
+        int sample = 0;
+
+        for (; sample + lanes <= numSamples; sample += lanes)
+        {
+            const auto l = load(left + sample);
+            const auto r = load(right + sample);
+            leftSquares = mulAdd(l, l, leftSquares);
+            rightSquares = mulAdd(r, r, rightSquares);
+            products = mulAdd(l, r, products);
+        }
+
+        SampleType partialSums[lanes];
+
+        for (auto [vector, sum] : { std::pair(leftSquares, sums), std::pair(rightSquares, sums + 1), std::pair(products, sums + 2) })
+        {
+            store(partialSums, vector);
+
+            for (auto partialSum : partialSums)
+                *sum += partialSum;
+        }
+
+        scalar::sumProducts(left + sample, right + sample, numSamples - sample, sums);
+    }
+}
+
+// The CPUID feature flags only say what the CPU can do. The wider registers are
+// usable only if the OS saves them on a context switch, which it reports in
+// XCR0: bits 1 and 2 for the SSE and AVX state, 5 to 7 for AVX-512's opmask and
+// upper ZMM registers.
+static constexpr unsigned long long avxState = 0x06;
+static constexpr unsigned long long avx512State = 0xe0;
+
+UTILITY_TARGET("xsave") static bool isStateEnabledByOS(unsigned long long state)
+{
+    // XGETBV faults unless the OS has enabled XSAVE, CPUID leaf 1 ECX bit 27
+   #if JUCE_MSVC
+    int registers[4] = {};
+    __cpuid(registers, 1);
+    const auto osxsave = (registers[2] & (1 << 27)) != 0;
+   #else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    const auto osxsave = __get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & (1u << 27)) != 0;
+   #endif
+
+    return osxsave && (_xgetbv(0) & state) == state;
+}
+
+#endif
+
+//==============================================================================
+template <typename SampleType>
+bool StereoKernels<SampleType>::isSupported(KernelBackend backend)
+{
+    switch (backend)
+    {
+#if JUCE_INTEL
+    case KernelBackend::sse2:   return juce::SystemStats::hasSSE2();
+    case KernelBackend::avx2:   return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3() && isStateEnabledByOS(avxState);
+    case KernelBackend::avx512: return juce::SystemStats::hasAVX512F() && isStateEnabledByOS(avxState | avx512State);
+#endif
+    case KernelBackend::scalar: return true;
+    default:                    return false;
+    }
+}
+
+template <typename SampleType>
+StereoKernels<SampleType> StereoKernels<SampleType>::forBackend(KernelBackend backend)
+{
+    jassert(isSupported(backend));
+
+    switch (backend)
+    {
+#if JUCE_INTEL
+    case KernelBackend::sse2:   return { sse2::applyMatrix<SampleType>, sse2::applyGains<SampleType>, sse2::sumProducts<SampleType>, backend };
+    case KernelBackend::avx2:   return { avx2::applyMatrix<SampleType>, avx2::applyGains<SampleType>, avx2::sumProducts<SampleType>, backend };
+    case KernelBackend::avx512: return { avx512::applyMatrix<SampleType>, avx512::applyGains<SampleType>, avx512::sumProducts<SampleType>, backend };
+#endif
+    default:                    return { scalar::applyMatrix<SampleType>, scalar::applyGains<SampleType>, scalar::sumProducts<SampleType>, KernelBackend::scalar };
+    }
+}
+
+template <typename SampleType>
+const StereoKernels<SampleType>& StereoKernels<SampleType>::get()
+{
+    static const auto kernels = []
+    {
+        for (auto backend : { KernelBackend::avx512, KernelBackend::avx2, KernelBackend::sse2 })
+            if (isSupported(backend))
+                return forBackend(backend);
+
+        return forBackend(KernelBackend::scalar);
+    }();
+
+    return kernels;
+}
+
+template <typename SampleType>
+bool StereoKernels<SampleType>::verifyBackend(KernelBackend backend, int toleranceUlps)
+{
+    jassert(isSupported(backend));
+
+    constexpr int maxLength = 259;
+    constexpr int maxOffset = 3;
+    juce::Random random(0x5eed);
+
+    auto randomSample = [&random] { return (SampleType)(2 * random.nextDouble() - 1); };
+
+    std::vector<SampleType> inputLeft(maxLength + maxOffset), inputRight(maxLength + maxOffset);
+    std::vector<SampleType> expectedLeft(inputLeft.size()), expectedRight(inputLeft.size());
+    std::vector<SampleType> actualLeft(inputLeft.size()), actualRight(inputLeft.size());
+
+    for (size_t i = 0; i < inputLeft.size(); ++i)
+    {
+        inputLeft[i] = randomSample();
+        inputRight[i] = randomSample();
+    }
+
+    const auto reference = forBackend(KernelBackend::scalar);
+
+    // A fused multiply-add rounds once instead of twice: allow a few ulp of
+    // the largest term that went into the result
+    constexpr auto ulp = std::numeric_limits<SampleType>::epsilon();
+    auto isClose = [ulp, toleranceUlps](SampleType expected, SampleType actual, SampleType magnitude)
+    {
+        return std::abs(expected - actual) <= (SampleType)toleranceUlps * ulp * juce::jmax(magnitude, ulp);
+    };
+
+    const auto kernels = forBackend(backend);
+
+    for (int trial = 0; trial < 16; ++trial)
+    {
+        const auto offset = random.nextInt(maxOffset + 1);
+        const auto length = random.nextInt(maxLength + 1);
+        const SampleType ll = 4 * randomSample(), lr = 4 * randomSample(), rl = 4 * randomSample(), rr = 4 * randomSample();
+
+        for (const auto diagonal : { false, true })
+        {
+            expectedLeft = actualLeft = inputLeft;
+            expectedRight = actualRight = inputRight;
+
+            if (diagonal)
+            {
+                reference.applyGains(expectedLeft.data() + offset, expectedRight.data() + offset, length, ll, rr);
+                kernels.applyGains(actualLeft.data() + offset, actualRight.data() + offset, length, ll, rr);
+            }
+            else
+            {
+                reference.applyMatrix(expectedLeft.data() + offset, expectedRight.data() + offset, length, ll, lr, rl, rr);
+                kernels.applyMatrix(actualLeft.data() + offset, actualRight.data() + offset, length, ll, lr, rl, rr);
+            }
+
+            for (size_t i = 0; i < inputLeft.size(); ++i)
+            {
+                const auto l = std::abs(inputLeft[i]);
+                const auto r = std::abs(inputRight[i]);
+                const auto leftMagnitude = diagonal ? std::abs(ll) * l : juce::jmax(std::abs(ll) * l, std::abs(lr) * r);
+                const auto rightMagnitude = diagonal ? std::abs(rr) * r : juce::jmax(std::abs(rl) * l, std::abs(rr) * r);
+
+                if (!isClose(expectedLeft[i], actualLeft[i], leftMagnitude)
+                    || !isClose(expectedRight[i], actualRight[i], rightMagnitude))
+                    return false;
+            }
+        }
+
+        // The sums are accumulated in a different order: allow a few ulp
+        // per term of the sum of the magnitudes, which for L * R is at
+        // most sqrt(sum of L * L * sum of R * R)
+        SampleType expectedSums[3] = {}, actualSums[3] = {};
+        reference.sumProducts(inputLeft.data() + offset, inputRight.data() + offset, length, expectedSums);
+        kernels.sumProducts(inputLeft.data() + offset, inputRight.data() + offset, length, actualSums);
+
+        const SampleType magnitudes[] = { expectedSums[0], expectedSums[1], std::sqrt(expectedSums[0] * expectedSums[1]) };
+
+        for (int i = 0; i < 3; ++i)
+            if (!isClose(expectedSums[i], actualSums[i], (SampleType)(length + 1) * magnitudes[i]))
+                return false;
+    }
+
+    return true;
+}
+
+template <typename SampleType>
+bool StereoKernels<SampleType>::verifyBackends()
+{
+    for (auto backend : { KernelBackend::sse2, KernelBackend::avx2, KernelBackend::avx512 })
+        if (isSupported(backend) && !verifyBackend(backend))
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+template struct StereoKernels<float>;
+template struct StereoKernels<double>;
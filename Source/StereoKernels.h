@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+
+// The loops behind StereoMatrix::process() and the meters, compiled for several
+// instruction sets in one binary. get() picks the widest one the CPU supports the first
+// time it is called; the processor calls it from its constructor so that never
+// happens on the audio thread.
+//
+// The vector backends use fused multiply-adds where the instruction set has
+// them, and sum in a different order, so they aren't bit-exact with the scalar
+// one: verifyBackends() checks they stay within a few ulp of it.
+enum class KernelBackend
+{
+    scalar,
+    sse2,
+    avx2,
+    avx512
+};
+
+template <typename SampleType>
+struct StereoKernels
+{
+    // L' = ll * L + lr * R, R' = rl * L + rr * R
+    using MatrixKernel = void (*)(SampleType* left, SampleType* right, int numSamples,
+                                  SampleType ll, SampleType lr, SampleType rl, SampleType rr);
+    // L' = leftGain * L, R' = rightGain * R
+    using GainKernel = void (*)(SampleType* left, SampleType* right, int numSamples,
+                                SampleType leftGain, SampleType rightGain);
+
+    // sums[0] += sum of L * L, sums[1] += sum of R * R, sums[2] += sum of L * R
+    using ProductSumKernel = void (*)(const SampleType* left, const SampleType* right, int numSamples, SampleType* sums);
+
+    MatrixKernel applyMatrix;
+    GainKernel applyGains;
+    ProductSumKernel sumProducts;
+    KernelBackend backend;
+
+    static const StereoKernels& get();
+
+    // True if both the CPU and the OS support the backend's instruction set
+    static bool isSupported(KernelBackend backend);
+    // Kernels of a given backend, which must be supported by this CPU
+    static StereoKernels forBackend(KernelBackend backend);
+
+    // Runs a backend, which must be supported, on random input including
+    // unaligned starts and lengths that leave a scalar tail. Returns false if
+    // it is further from the scalar reference than toleranceUlps ulp of the
+    // largest term that went into each result.
+    static bool verifyBackend(KernelBackend backend, int toleranceUlps = defaultToleranceUlps);
+    // verifyBackend() for every vector backend this CPU supports, run by
+    // Tools/UtilityTests
+    static bool verifyBackends();
+
+    static constexpr int defaultToleranceUlps = 4;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StereoKernels.h"
+
+
+// A 2x2 gain matrix acting on a stereo pair:
+//
+//   L' = ll * L + lr * R
+//   R' = rl * L + rr * R
+//
+// Every linear L/R stage of the plugin (polarity, mode, width, mid/side, mono,
+// gain and balance) is one of these, so a whole chain of them collapses into a
+// single matrix that is applied to the buffer in one pass.
+template <typename SampleType>
+struct StereoMatrix
+{
+    SampleType ll = 1, lr = 0, rl = 0, rr = 1;
+
+    static StereoMatrix identity() { return {}; }
+
+    static StereoMatrix diagonal(SampleType left, SampleType right)
+    {
+        return { left, 0, 0, right };
+    }
+
+    static StereoMatrix polarity(bool invertLeft, bool invertRight)
+    {
+        return diagonal(invertLeft ? SampleType(-1) : SampleType(1),
+                        invertRight ? SampleType(-1) : SampleType(1));
+    }
+
+    // Index of the "Mode" parameter: Stereo, Left, Right, Swap
+    static StereoMatrix mode(int modeIndex)
+    {
+        switch (modeIndex)
+        {
+        case 1: return diagonal(1, 0); // left
+        case 2: return diagonal(0, 1); // right
+        case 3: return { 0, 1, 1, 0 }; // swap
+        default: return identity();    // stereo
+        }
+    }
+
+    // mid = (L + R) / 2, side = (L - R) / 2, L' = mid * m + side * s, R' = mid * m - side * s
+    static StereoMatrix midSideScale(SampleType midGain, SampleType sideGain)
+    {
+        const auto a = SampleType(0.5) * (midGain + sideGain);
+        const auto b = SampleType(0.5) * (midGain - sideGain);
+        return { a, b, b, a };
+    }
+
+    static StereoMatrix width(SampleType width) { return midSideScale(1, width); }
+
+    static StereoMatrix midSideBalance(SampleType balance) { return midSideScale(1 - balance, 1 + balance); }
+
+    static StereoMatrix mono() { return midSideScale(1, 0); }
+
+    // Same gains as juce::dsp::Panner with PannerRule::balanced, pan in [-1, 1]
+    static StereoMatrix balance(SampleType pan)
+    {
+        const auto normalisedPan = SampleType(0.5) * (pan + 1);
+        return diagonal(2 * juce::jmin(SampleType(0.5), 1 - normalisedPan),
+                        2 * juce::jmin(SampleType(0.5), normalisedPan));
+    }
+
+    // Returns the matrix that applies `first` and then this one.
+    StereoMatrix operator* (const StereoMatrix& first) const
+    {
+        return { ll * first.ll + lr * first.rl, ll * first.lr + lr * first.rr,
+                 rl * first.ll + rr * first.rl, rl * first.lr + rr * first.rr };
+    }
+
+    StereoMatrix operator* (SampleType gain) const
+    {
+        return { ll * gain, lr * gain, rl * gain, rr * gain };
+    }
+
+    bool isDiagonal() const { return lr == 0 && rl == 0; }
+
+    bool isIdentity() const { return isDiagonal() && ll == 1 && rr == 1; }
+
+    void processSample(SampleType& left, SampleType& right) const
+    {
+        const auto l = left;
+        const auto r = right;
+
+        left = ll * l + lr * r;
+        right = rl * l + rr * r;
+    }
+
+    // Runs on the widest instruction set the CPU has, see StereoKernels
+    void process(SampleType* left, SampleType* right, int numSamples) const
+    {
+        const auto& kernels = StereoKernels<SampleType>::get();
+
+        if (isDiagonal())
+        {
+            if (ll != 1 || rr != 1)
+                kernels.applyGains(left, right, numSamples, ll, rr);
+
+            return;
+        }
+
+        kernels.applyMatrix(left, right, numSamples, ll, lr, rl, rr);
+    }
+
+    // Same as process(), with a per-sample scalar gain ramp applied on top of the matrix.
+    void process(SampleType* left, SampleType* right, int numSamples, juce::SmoothedValue<SampleType>& gain) const
+    {
+        if (!gain.isSmoothing())
+        {
+            (*this * gain.getTargetValue()).process(left, right, numSamples);
+            return;
+        }
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const auto g = gain.getNextValue();
+            const auto l = left[sample];
+            const auto r = right[sample];
+
+            left[sample] = g * (ll * l + lr * r);
+            right[sample] = g * (rl * l + rr * r);
+        }
+    }
+};
@@ -0,0 +1,119 @@
+#include "TruePeakMeter.h"
+
+
+// ITU-R BS.1770-4 Annex 2; each phase is the previous one's mirror image
+const float TruePeakMeter::coefficients[numPhases][tapsPerPhase] =
+{
+    {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+       0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+       0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+    { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+       0.4650878906250f, -0.1665039062500f,  0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+    { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+       0.1373291015625f, -0.0594482421875f,  0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f }
+};
+
+const float TruePeakMeter::maximumOvershoot = []
+{
+    float overshoot = 0;
+
+    for (const auto& phase : coefficients)
+    {
+        float sum = 0;
+
+        for (auto coefficient : phase)
+            sum += std::abs(coefficient);
+
+        overshoot = juce::jmax(overshoot, sum);
+    }
+
+    return overshoot;
+}();
+
+void TruePeakMeter::reset()
+{
+    for (auto& channel : samples)
+        channel.fill(0);
+
+    chunkLength = 0;
+    heldPeak.fill(0);
+
+    for (auto& peak : maxTruePeak)
+        peak.store(0, std::memory_order_relaxed);
+}
+
+template <typename SampleType>
+void TruePeakMeter::process(const juce::AudioBuffer<SampleType>& tile)
+{
+    if (tile.getNumChannels() == 0)
+        return;
+
+    if (resetRequested.load(std::memory_order_relaxed) && resetRequested.exchange(false))
+        reset();
+
+    const SampleType* channels[] = { tile.getReadPointer(0), tile.getReadPointer(juce::jmin(1, tile.getNumChannels() - 1)) };
+    const auto numSamples = tile.getNumSamples();
+
+    for (int start = 0; start < numSamples;)
+    {
+        const auto count = juce::jmin(numSamples - start, chunkSize - chunkLength);
+
+        for (size_t channel = 0; channel < 2; ++channel)
+        {
+            auto* destination = samples[channel].data() + historySize + chunkLength;
+
+            for (int sample = 0; sample < count; ++sample)
+                destination[sample] = (float)channels[channel][start + sample];
+        }
+
+        chunkLength += count;
+        start += count;
+
+        if (chunkLength < chunkSize)
+            continue;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            heldPeak[(size_t)channel] = processChannel(channel, heldPeak[(size_t)channel]);
+            maxTruePeak[(size_t)channel].store(heldPeak[(size_t)channel], std::memory_order_relaxed);
+        }
+
+        chunkLength = 0;
+    }
+}
+
+float TruePeakMeter::processChannel(int channel, float peak)
+{
+    auto& buffer = samples[(size_t)channel];
+
+    // Interpolated values depend on the chunk and the history before it
+    const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.data(), historySize + chunkSize);
+    const auto samplePeak = juce::jmax(-range.getStart(), range.getEnd());
+
+    if (samplePeak * maximumOvershoot > peak)
+    {
+        for (int sample = 0; sample < chunkSize; ++sample)
+        {
+            // The newest tap is at index historySize + sample
+            const auto* window = buffer.data() + sample;
+
+            for (const auto& phase : coefficients)
+            {
+                float value = 0;
+
+                for (int tap = 0; tap < tapsPerPhase; ++tap)
+                    value += phase[tap] * window[historySize - tap];
+
+                peak = juce::jmax(peak, std::abs(value));
+            }
+        }
+    }
+
+    std::copy(buffer.end() - historySize, buffer.end(), buffer.begin());
+    return peak;
+}
+
+//==============================================================================
+template void TruePeakMeter::process(const juce::AudioBuffer<float>&);
+template void TruePeakMeter::process(const juce::AudioBuffer<double>&);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+
+// ITU-R BS.1770 true peak of a stereo signal: the highest absolute value of
+// the signal oversampled four times, held until reset.
+//
+// The oversampling is the standard's 48 tap polyphase interpolator, run as
+// four 12 tap filters on the original rate. A stretch of samples whose
+// interpolated values provably can't exceed the peak held so far (its sample
+// peak times the filters' largest gain) skips the filters altogether, so once
+// a peak is established most blocks cost only a sample peak search.
+class TruePeakMeter
+{
+public:
+    TruePeakMeter() { reset(); }
+
+    // Audio thread. A mono signal is measured as both left and right.
+    template <typename SampleType>
+    void process(const juce::AudioBuffer<SampleType>& tile);
+
+    // Any thread: highest true peak of a channel since the last reset, as a gain
+    float getMaxTruePeak(int channel) const { return maxTruePeak[(size_t)channel].load(std::memory_order_relaxed); }
+
+    // Clears the held peaks at the next block
+    void requestReset() { resetRequested.store(true); }
+
+private:
+    // Checks the skipped chunks against the unskipped interpolation
+    friend class TruePeakMeterTest;
+
+    void reset();
+    float processChannel(int channel, float peak);
+
+    static constexpr int numPhases = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int historySize = tapsPerPhase - 1;
+    static constexpr int chunkSize = 64;
+
+    static const float coefficients[numPhases][tapsPerPhase];
+    // The largest sum of absolute coefficients of a phase: no interpolated
+    // value exceeds the surrounding samples' peak by more than this
+    static const float maximumOvershoot;
+
+    // Per channel: the last historySize samples, then the chunk being measured
+    std::array<std::array<float, historySize + chunkSize>, 2> samples{};
+    int chunkLength = 0;
+
+    std::array<float, 2> heldPeak{};
+    std::array<std::atomic<float>, 2> maxTruePeak;
+    std::atomic<bool> resetRequested{ false };
+};
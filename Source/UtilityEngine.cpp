@@ -0,0 +1,534 @@
+#include "UtilityEngine.h"
+
+
+template <typename SampleType>
+void UtilityEngine<SampleType>::prepare(const juce::dsp::ProcessSpec& spec, const UtilityParameters& parameters)
+{
+    gain.reset(spec.sampleRate, 0.03);
+    smoothedWidth.reset(spec.sampleRate, 0.03);
+    smoothedMidSide.reset(spec.sampleRate, 0.03);
+    smoothedPan.reset(spec.sampleRate, 0.03);
+
+    setSmoothedTargets(parameters);
+    gain.setCurrentAndTargetValue(gain.getTargetValue());
+    smoothedWidth.setCurrentAndTargetValue(smoothedWidth.getTargetValue());
+    smoothedMidSide.setCurrentAndTargetValue(smoothedMidSide.getTargetValue());
+    smoothedPan.setCurrentAndTargetValue(smoothedPan.getTargetValue());
+
+    crossoverFrequency = (SampleType)parameters.bassMonoCrossover;
+
+    dcBlocker.prepare(spec.sampleRate);
+    dcBlocker.setParameters((SampleType)parameters.dcCutoff, parameters.dcOrder);
+    dcEnabled = parameters.dc;
+
+    crossover.prepare(spec.sampleRate, crossoverFrequency);
+
+    linearPhase.prepare(spec, parameters.bassMonoCrossover);
+
+    if (spec.numChannels == 2 && parameters.bassMono && parameters.bassMonoMode == UtilityParameters::linearPhaseBassMono)
+        linearPhase.activate();
+
+    activeBassMonoMode = parameters.bassMonoMode;
+    isSilent = false;
+}
+
+template <typename SampleType>
+void UtilityEngine<SampleType>::reset()
+{
+    gain.setCurrentAndTargetValue(gain.getTargetValue());
+    smoothedWidth.setCurrentAndTargetValue(smoothedWidth.getTargetValue());
+    smoothedMidSide.setCurrentAndTargetValue(smoothedMidSide.getTargetValue());
+    smoothedPan.setCurrentAndTargetValue(smoothedPan.getTargetValue());
+
+    resetFilters();
+}
+
+template <typename SampleType>
+void UtilityEngine<SampleType>::resetFilters()
+{
+    crossover.reset();
+    linearPhase.reset();
+    dcBlocker.reset();
+}
+
+template <typename SampleType>
+void UtilityEngine<SampleType>::setSmoothedTargets(const UtilityParameters& parameters)
+{
+    gain.setTargetValue(parameters.mute ? SampleType(0) : juce::Decibels::decibelsToGain((SampleType)parameters.gainDecibels));
+    smoothedWidth.setTargetValue((SampleType)parameters.width);
+    smoothedMidSide.setTargetValue((SampleType)parameters.midSide);
+    smoothedPan.setTargetValue((SampleType)parameters.balance);
+}
+
+template <typename SampleType>
+void UtilityEngine<SampleType>::processCrossoverBassMono(juce::AudioBuffer<SampleType>& buffer)
+{
+    if (activeBassMonoMode == UtilityParameters::linearPhaseBassMono)
+    {
+        linearPhase.setCrossoverFrequency((float)crossoverFrequency);
+        linearPhase.process(buffer, bassMonoPreview);
+        return;
+    }
+
+    // Each channel is split into both bands by one filter, the low bands are
+    // summed to mono and added back to the high bands
+    crossover.setCutoffFrequency(crossoverFrequency);
+
+    auto* leftChannel = buffer.getWritePointer(0);
+    auto* rightChannel = buffer.getWritePointer(1);
+
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    {
+        SampleType lowLeft, highLeft, lowRight, highRight;
+
+        crossover.advance();
+        crossover.processSample(0, leftChannel[sample], lowLeft, highLeft);
+        crossover.processSample(1, rightChannel[sample], lowRight, highRight);
+
+        const auto low = (lowLeft + lowRight) * SampleType(0.5);
+
+        if (bassMonoPreview)
+        {
+            leftChannel[sample] = low;
+            rightChannel[sample] = low;
+        }
+        else if (lowBandOutput != nullptr)
+        {
+            lowBandOutput[sample] += 2 * low;
+            leftChannel[sample] = highLeft;
+            rightChannel[sample] = highRight;
+        }
+        else
+        {
+            leftChannel[sample] = highLeft + low;
+            rightChannel[sample] = highRight + low;
+        }
+    }
+
+    crossover.snapToZero();
+}
+
+template <typename SampleType>
+void UtilityEngine<SampleType>::processSideBassMono(juce::AudioBuffer<SampleType>& buffer)
+{
+    // Summing the low band to mono only ever changes the side signal, so instead
+    // of splitting both channels into two bands only the side is high-passed.
+    // The mid passes through untouched.
+    crossover.setCutoffFrequency(crossoverFrequency);
+
+    auto* leftChannel = buffer.getWritePointer(0);
+    auto* rightChannel = buffer.getWritePointer(1);
+    SampleType low, high;
+
+    if (bassMonoPreview)
+    {
+        // Solo the low band: the low-passed mid on both channels. The mid has
+        // its own filter state, channel 0 keeps the side's for switching back.
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        {
+            crossover.advance();
+            crossover.processSample(1, (leftChannel[sample] + rightChannel[sample]) * SampleType(0.5), low, high);
+            leftChannel[sample] = low;
+            rightChannel[sample] = low;
+        }
+
+        crossover.snapToZero();
+        return;
+    }
+
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    {
+        SampleType mid = (leftChannel[sample] + rightChannel[sample]) * SampleType(0.5);
+        SampleType side = (leftChannel[sample] - rightChannel[sample]) * SampleType(0.5);
+
+        crossover.advance();
+        crossover.processSample(0, side, low, high);
+
+        leftChannel[sample] = mid + high;
+        rightChannel[sample] = mid - high;
+    }
+
+    crossover.snapToZero();
+}
+
+template <typename SampleType>
+TileResult UtilityEngine<SampleType>::process(juce::AudioBuffer<SampleType>& buffer, int numInputChannels, const UtilityParameters& parameters,
+                                              SampleType* lowBandDestination)
+{
+    // Mute
+    //
+    // Muting ramps the gain down to zero, so it fades like any other gain
+    // change. Once the fade has finished there is nothing left to compute.
+    setSmoothedTargets(parameters);
+
+    if (parameters.mute && !gain.isSmoothing())
+    {
+        if (!isSilent)
+        {
+            // Unmuting fades in from silence, don't replay the filter state from before the mute
+            resetFilters();
+            isSilent = true;
+        }
+
+        buffer.clear();
+        return TileResult::silent;
+    }
+
+    isSilent = false;
+    lowBandOutput = lowBandDestination;
+
+    const auto unchanged = processUnmuted(buffer, numInputChannels, parameters);
+
+    // The linear phase bass mono delays the signal. Whatever bypasses it (bass
+    // mono off, single channels, pairs without the stereo stages) is delayed by
+    // the same amount, so all channels line up with the latency the host compensates.
+    if (parameters.bassMonoMode == UtilityParameters::linearPhaseBassMono && !(parameters.bassMono && buffer.getNumChannels() == 2))
+    {
+        UTILITY_PROFILE_STAGE(profiler, bassMonoStage);
+        linearPhase.delay(buffer);
+        return TileResult::processed;
+    }
+
+    return unchanged ? TileResult::unchanged : TileResult::processed;
+}
+
+template <typename SampleType>
+bool UtilityEngine<SampleType>::processUnmuted(juce::AudioBuffer<SampleType>& buffer, int numInputChannels, const UtilityParameters& parameters)
+{
+    auto numSamples = buffer.getNumSamples();
+
+    // inv L inv R, Mode, Stereo Width / MidSide balance, Mono
+    //
+    // All of these are linear L/R operations, so they are folded into a single
+    // matrix and applied to the buffer in one pass further down. Width, mid/side
+    // and balance are smoothed; while any of them ramps, the matrix is rebuilt
+    // per sample, otherwise it is constant for the whole block.
+
+    // DC
+    //
+    // Switched on, the blocker starts from silence rather than from wherever
+    // it was left when it was last switched off.
+    if (parameters.dc && !dcEnabled)
+        dcBlocker.reset();
+
+    dcEnabled = parameters.dc;
+    dcBlocker.setParameters((SampleType)parameters.dcCutoff, parameters.dcOrder);
+
+    matrixSettings.polarityAndMode = Matrix::mode(parameters.mode) * Matrix::polarity(parameters.invertLeft, parameters.invertRight);
+    matrixSettings.stereoInput = buffer.getNumChannels() == 2;
+    matrixSettings.midSideMode = parameters.midSideMode;
+    matrixSettings.mono = parameters.mono;
+
+    crossoverFrequency = (SampleType)parameters.bassMonoCrossover;
+    bassMonoPreview = parameters.bassMonoPreview;
+
+    const auto matrixRamp = smoothedWidth.isSmoothing() || smoothedMidSide.isSmoothing() || smoothedPan.isSmoothing();
+
+    // Gain and Balance are applied after the bass mono crossover, as a diagonal
+    // matrix scaled by the (ramped) gain.
+    const auto preMatrix = getPreMatrix();
+    const auto postMatrix = getPostMatrix();
+
+    if (buffer.getNumChannels() < 2)
+        return processMono(buffer, parameters);
+
+    if (numInputChannels < 2)
+    {
+        // The bass mono crossover (and its low band output) needs both
+        // channels, so it goes through the full stereo chain
+        if (!parameters.bassMono)
+        {
+            processMonoToStereo(buffer, parameters, matrixRamp);
+            return false;
+        }
+
+        buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+    }
+
+    // All parameters at their defaults (or cancelling each other out): the
+    // output is the input. Only taken once any gain ramp has settled.
+    if (!parameters.bassMono && !parameters.dc && !gain.isSmoothing() && !matrixRamp
+        && (postMatrix * preMatrix * gain.getTargetValue()).isIdentity())
+        return true;
+
+    int stages = 0;
+
+    if (parameters.bassMono)
+    {
+        // Only the crossover engine has a low band to send elsewhere
+        const auto bassMonoMode = lowBandOutput != nullptr ? (int)UtilityParameters::crossoverBassMono : parameters.bassMonoMode;
+
+        // The filters of the inactive engine hold stale state, start from silence
+        if (bassMonoMode != activeBassMonoMode)
+        {
+            crossover.reset();
+            linearPhase.reset();
+            activeBassMonoMode = bassMonoMode;
+        }
+
+        stages |= bassMonoMode == UtilityParameters::sideBassMono ? sideBassMonoStage : crossoverBassMonoStage;
+
+        if (!preMatrix.isIdentity() || matrixRamp)
+            stages |= preMatrixStage;
+    }
+
+    if (matrixRamp)
+        stages |= matrixRampStage;
+    else if (gain.isSmoothing())
+        stages |= gainRampStage;
+
+    if (parameters.dc)
+        stages |= dcStage;
+
+    static const auto kernels = makeStageKernels(std::make_integer_sequence<int, numStageCombinations>());
+    (this->*kernels[(size_t)stages])(buffer, preMatrix, postMatrix);
+    return false;
+}
+
+template <typename SampleType>
+bool UtilityEngine<SampleType>::processMono(juce::AudioBuffer<SampleType>& buffer, const UtilityParameters& parameters)
+{
+    // Mono in, mono out: only gain, polarity and DC mean anything here
+    auto* channelData = buffer.getWritePointer(0);
+    auto numSamples = buffer.getNumSamples();
+    const auto polarity = parameters.invertLeft ? SampleType(-1) : SampleType(1);
+    const auto unchanged = !gain.isSmoothing() && polarity * gain.getTargetValue() == 1 && !parameters.dc;
+
+    smoothedWidth.skip(numSamples);
+    smoothedMidSide.skip(numSamples);
+    smoothedPan.skip(numSamples);
+
+    {
+        UTILITY_PROFILE_STAGE(profiler, gainStage);
+
+        if (gain.isSmoothing())
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+                channelData[sample] *= polarity * gain.getNextValue();
+        }
+        else if (polarity * gain.getTargetValue() != 1)
+        {
+            juce::FloatVectorOperations::multiply(channelData, polarity * gain.getTargetValue(), numSamples);
+        }
+    }
+
+    // Remove DC
+    if (parameters.dc)
+    {
+        UTILITY_PROFILE_STAGE(profiler, dcStage);
+        dcBlocker.process(channelData, numSamples);
+    }
+
+    return unchanged;
+}
+
+template <typename SampleType>
+void UtilityEngine<SampleType>::processMonoToStereo(juce::AudioBuffer<SampleType>& buffer, const UtilityParameters& parameters, bool matrixRamp)
+{
+    // Mono in, stereo out: the source feeds both sides of the matrix, so the
+    // whole chain reduces to one gain per output channel.
+    auto* leftChannel = buffer.getWritePointer(0);
+    auto* rightChannel = buffer.getWritePointer(1);
+    auto numSamples = buffer.getNumSamples();
+
+    // DC is removed from the source before it is spread to both channels,
+    // which takes one filter instead of two
+    if (parameters.dc)
+    {
+        UTILITY_PROFILE_STAGE(profiler, dcStage);
+        dcBlocker.process(leftChannel, numSamples);
+    }
+
+    UTILITY_PROFILE_STAGE(profiler, matrixStage);
+
+    if (matrixRamp || gain.isSmoothing())
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            advancePreMatrix();
+            smoothedPan.getNextValue();
+            const auto [left, right] = getMonoToStereoGains();
+            const auto g = gain.getNextValue();
+
+            rightChannel[sample] = leftChannel[sample] * right * g;
+            leftChannel[sample] = leftChannel[sample] * left * g;
+        }
+
+        return;
+    }
+
+    const auto [left, right] = getMonoToStereoGains();
+    juce::FloatVectorOperations::multiply(rightChannel, leftChannel, right * gain.getTargetValue(), numSamples);
+    juce::FloatVectorOperations::multiply(leftChannel, left * gain.getTargetValue(), numSamples);
+}
+
+template <typename SampleType>
+std::pair<SampleType, SampleType> UtilityEngine<SampleType>::getMonoToStereoGains() const
+{
+    const auto matrix = getPostMatrix() * getPreMatrix();
+    return { matrix.ll + matrix.lr, matrix.rl + matrix.rr };
+}
+
+template <typename SampleType>
+template <int stages>
+void UtilityEngine<SampleType>::processStages(juce::AudioBuffer<SampleType>& buffer, const Matrix& preMatrix, const Matrix& postMatrix)
+{
+    auto* leftChannel = buffer.getWritePointer(0);
+    auto* rightChannel = buffer.getWritePointer(1);
+    auto numSamples = buffer.getNumSamples();
+
+    if constexpr ((stages & (crossoverBassMonoStage | sideBassMonoStage)) == 0)
+    {
+        // Without the crossover the whole linear chain is a single matrix
+        UTILITY_PROFILE_STAGE(profiler, matrixStage);
+
+        if constexpr ((stages & matrixRampStage) != 0)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                advancePreMatrix();
+                smoothedPan.getNextValue();
+                const auto matrix = getPostMatrix() * getPreMatrix() * gain.getNextValue();
+                matrix.processSample(leftChannel[sample], rightChannel[sample]);
+            }
+        }
+        else if constexpr ((stages & gainRampStage) != 0)
+        {
+            (postMatrix * preMatrix).process(leftChannel, rightChannel, numSamples, gain);
+        }
+        else
+        {
+            (postMatrix * preMatrix * gain.getTargetValue()).process(leftChannel, rightChannel, numSamples);
+        }
+    }
+    else
+    {
+        {
+            UTILITY_PROFILE_STAGE(profiler, matrixStage);
+
+            if constexpr ((stages & matrixRampStage) != 0)
+            {
+                for (int sample = 0; sample < numSamples; ++sample)
+                {
+                    advancePreMatrix();
+                    getPreMatrix().processSample(leftChannel[sample], rightChannel[sample]);
+                }
+            }
+            else if constexpr ((stages & preMatrixStage) != 0)
+            {
+                preMatrix.process(leftChannel, rightChannel, numSamples);
+            }
+        }
+
+        {
+            UTILITY_PROFILE_STAGE(profiler, bassMonoStage);
+
+            if constexpr ((stages & sideBassMonoStage) != 0)
+                processSideBassMono(buffer);
+            else
+                processCrossoverBassMono(buffer);
+        }
+
+        UTILITY_PROFILE_STAGE(profiler, gainStage);
+
+        if constexpr ((stages & matrixRampStage) != 0)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                smoothedPan.getNextValue();
+                const auto matrix = getPostMatrix() * gain.getNextValue();
+                matrix.processSample(leftChannel[sample], rightChannel[sample]);
+            }
+        }
+        else if constexpr ((stages & gainRampStage) != 0)
+        {
+            postMatrix.process(leftChannel, rightChannel, numSamples, gain);
+        }
+        else
+        {
+            (postMatrix * gain.getTargetValue()).process(leftChannel, rightChannel, numSamples);
+        }
+    }
+
+    if constexpr ((stages & dcStage) != 0)
+    {
+        UTILITY_PROFILE_STAGE(profiler, dcStage);
+        dcBlocker.process(leftChannel, rightChannel, numSamples);
+    }
+}
+
+template <typename SampleType>
+template <int... stages>
+std::array<typename UtilityEngine<SampleType>::StageKernel, sizeof...(stages)> UtilityEngine<SampleType>::makeStageKernels(std::integer_sequence<int, stages...>)
+{
+    return { &UtilityEngine::template processStages<stages>... };
+}
+
+template <typename SampleType>
+StereoMatrix<SampleType> UtilityEngine<SampleType>::getPreMatrix() const
+{
+    auto matrix = matrixSettings.polarityAndMode;
+
+    if (matrixSettings.stereoInput)
+    {
+        if (matrixSettings.midSideMode)
+            matrix = Matrix::midSideBalance(smoothedMidSide.getCurrentValue()) * matrix;
+        else
+            matrix = Matrix::width(smoothedWidth.getCurrentValue()) * matrix;
+
+        if (matrixSettings.mono)
+            matrix = Matrix::mono() * matrix;
+    }
+
+    return matrix;
+}
+
+template <typename SampleType>
+StereoMatrix<SampleType> UtilityEngine<SampleType>::getPostMatrix() const
+{
+    return Matrix::balance(smoothedPan.getCurrentValue());
+}
+
+template <typename SampleType>
+void UtilityEngine<SampleType>::advancePreMatrix()
+{
+    smoothedWidth.getNextValue();
+    smoothedMidSide.getNextValue();
+}
+
+template <typename SampleType>
+int UtilityEngine<SampleType>::getWarmUpSamples(const UtilityParameters& parameters, double sampleRate)
+{
+    // ln(10^7) time constants of the slowest pole, with a quarter more for the
+    // crossover's double poles. Measured with noise, bass and a DC offset.
+    constexpr auto timeConstants = 1.25 * 16.12;
+    constexpr auto twoPi = juce::MathConstants<double>::twoPi;
+    constexpr auto butterworthDamping = juce::MathConstants<double>::sqrt2 * 0.5;
+
+    auto slowestDecayRate = std::numeric_limits<double>::max();
+
+    if (parameters.dc)
+        slowestDecayRate = twoPi * parameters.dcCutoff * (parameters.dcOrder == 1 ? 1.0 : butterworthDamping);
+
+    if (parameters.bassMono && parameters.bassMonoMode != UtilityParameters::linearPhaseBassMono)
+    {
+        const auto crossoverFrequency = juce::jlimit((double)LinkwitzRileyCrossover<SampleType>::minimumFrequency,
+                                                     (double)LinkwitzRileyCrossover<SampleType>::maximumFrequency,
+                                                     (double)parameters.bassMonoCrossover);
+        slowestDecayRate = juce::jmin(slowestDecayRate, twoPi * crossoverFrequency * butterworthDamping);
+    }
+
+    auto samples = slowestDecayRate < std::numeric_limits<double>::max()
+                 ? (int)std::ceil(timeConstants / slowestDecayRate * sampleRate)
+                 : 0;
+
+    // The FIR and the delay line have finite memory, twice the latency covers both
+    if (parameters.bassMonoMode == UtilityParameters::linearPhaseBassMono)
+        samples = juce::jmax(samples, 2 * getLinearPhaseLatencySamples(sampleRate));
+
+    return samples;
+}
+
+//==============================================================================
+template class UtilityEngine<float>;
+template class UtilityEngine<double>;
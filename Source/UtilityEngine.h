@@ -0,0 +1,162 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StereoMatrix.h"
+#include "LinkwitzRileyCrossover.h"
+#include "DCBlocker.h"
+#include "LinearPhaseBassMono.h"
+#include "DspProfiler.h"
+
+
+// Plain values of the plugin parameters, read once per tile by the processor
+struct UtilityParameters
+{
+    enum BassMonoMode { crossoverBassMono, sideBassMono, linearPhaseBassMono };
+
+    float gainDecibels = 0.f;
+    float balance = 0.f;            // -1 (left) to 1 (right)
+    float width = 1.f;              // 0 to 4
+    float midSide = 0.f;            // -1 (mid) to 1 (side)
+    float bassMonoCrossover = 120.f;
+    float dcCutoff = 10.f;
+    int mode = 0;                   // Stereo, Left, Right, Swap
+    int bassMonoMode = 0;           // Crossover, Side, Linear Phase
+    int dcOrder = 2;                // 1 or 2
+    bool midSideMode = false;
+    bool mute = false;
+    bool dc = false;
+    bool mono = false;
+    bool bassMono = false;
+    bool bassMonoPreview = false;
+    bool invertLeft = false;
+    bool invertRight = false;
+    bool allPairs = true;           // surround layouts: width, balance etc. on every pair or only the front one
+    bool bassToLFE = false;         // surround layouts: bass mono low band goes to the LFE channel
+};
+
+
+// What UtilityEngine::process() did to a tile, so the processor can skip
+// measuring the output when it already knows what it is
+enum class TileResult
+{
+    processed,
+    unchanged,      // the output is the input
+    silent          // muted, the output is all zeros
+};
+
+
+// The plugin's DSP chain, for either sample type:
+// polarity, mode, width / mid-side, mono, bass mono, gain, balance, mute, DC.
+template <typename SampleType>
+class UtilityEngine
+{
+public:
+    void prepare(const juce::dsp::ProcessSpec& spec, const UtilityParameters& parameters);
+    void reset();
+
+    // Processes one tile of a mono or stereo buffer with the given parameter values.
+    // A stereo buffer with one input channel is treated as a mono source.
+    // With a lowBandOutput, the crossover adds its low band there (summed over
+    // both channels) instead of back into the buffer. Not supported by the
+    // linear phase mode.
+    TileResult process(juce::AudioBuffer<SampleType>& buffer, int numInputChannels, const UtilityParameters& parameters,
+                       SampleType* lowBandOutput = nullptr);
+
+    // False while these parameters run the linear phase filter and its first
+    // kernel, designed in the background after prepare(), hasn't been picked
+    // up by process() yet
+    bool isReady(const UtilityParameters& parameters) const
+    {
+        return !parameters.bassMono || parameters.mute
+            || parameters.bassMonoMode != UtilityParameters::linearPhaseBassMono
+            || linearPhase.isKernelLoaded();
+    }
+
+    // Starts preparing the linear phase filter, see LinearPhaseBassMono::activate()
+    void activateLinearPhase() { linearPhase.activate(); }
+
+    // Latency of the linear phase bass mono mode, which every engine applies in that mode
+    static int getLinearPhaseLatencySamples(double sampleRate) { return LinearPhaseBassMono<SampleType>::getLatencySamples(sampleRate); }
+
+    // Input needed ahead of any point of a stream for the output from there on
+    // to match processing the whole stream: by then the filters have forgotten
+    // their start, to below -140 dB. For rendering a file in chunks.
+    static int getWarmUpSamples(const UtilityParameters& parameters, double sampleRate);
+
+#if UTILITY_ENABLE_PROFILING
+    // The stages time themselves into this one while it is set
+    void setProfiler(DspProfiler* profilerToUse) { profiler = profilerToUse; }
+#endif
+
+private:
+    using Matrix = StereoMatrix<SampleType>;
+
+    // Both return true if they left the buffer as it was
+    bool processUnmuted(juce::AudioBuffer<SampleType>& buffer, int numInputChannels, const UtilityParameters& parameters);
+    bool processMono(juce::AudioBuffer<SampleType>& buffer, const UtilityParameters& parameters);
+
+    void processMonoToStereo(juce::AudioBuffer<SampleType>& buffer, const UtilityParameters& parameters, bool matrixRamp);
+    // Left and right gain applied to a mono source by the current matrices, without the gain
+    std::pair<SampleType, SampleType> getMonoToStereoGains() const;
+
+    void processCrossoverBassMono(juce::AudioBuffer<SampleType>& buffer);
+    void processSideBassMono(juce::AudioBuffer<SampleType>& buffer);
+
+    // The stages that are enabled for a block form a bitmask, which selects one
+    // of the processStages() specialisations. Disabled stages are compiled out.
+    enum Stage
+    {
+        preMatrixStage          = 1 << 0, // matrix ahead of the crossover is not the identity
+        gainRampStage           = 1 << 1, // only the gain is ramping
+        matrixRampStage         = 1 << 2, // width, mid/side or balance is ramping
+        crossoverBassMonoStage  = 1 << 3, // minimum or linear phase
+        sideBassMonoStage       = 1 << 4,
+        dcStage                 = 1 << 5,
+        numStageCombinations    = 1 << 6
+    };
+
+    using StageKernel = void (UtilityEngine::*)(juce::AudioBuffer<SampleType>&, const Matrix&, const Matrix&);
+
+    template <int stages>
+    void processStages(juce::AudioBuffer<SampleType>& buffer, const Matrix& preMatrix, const Matrix& postMatrix);
+
+    template <int... stages>
+    static std::array<StageKernel, sizeof...(stages)> makeStageKernels(std::integer_sequence<int, stages...>);
+
+    // Matrix ahead of the crossover, built from matrixSettings and the current smoothed values
+    Matrix getPreMatrix() const;
+    // Balance matrix after the crossover, without the gain
+    Matrix getPostMatrix() const;
+    void advancePreMatrix();
+
+    void setSmoothedTargets(const UtilityParameters& parameters);
+    void resetFilters();
+
+    struct MatrixSettings
+    {
+        Matrix polarityAndMode;
+        bool stereoInput = false;
+        bool midSideMode = false;
+        bool mono = false;
+    };
+
+    MatrixSettings matrixSettings;
+
+    SampleType crossoverFrequency = 120;
+    bool bassMonoPreview = false;
+    SampleType* lowBandOutput = nullptr;
+
+    juce::SmoothedValue<SampleType> gain;
+    juce::SmoothedValue<SampleType> smoothedWidth, smoothedMidSide, smoothedPan;
+    DCBlocker<SampleType> dcBlocker;
+    bool dcEnabled = false;
+    // Shared by the crossover and side modes, which reset it when switching
+    LinkwitzRileyCrossover<SampleType> crossover;
+    LinearPhaseBassMono<SampleType> linearPhase;
+    int activeBassMonoMode{ 0 };
+    bool isSilent{ false };
+
+#if UTILITY_ENABLE_PROFILING
+    DspProfiler* profiler = nullptr;
+#endif
+};
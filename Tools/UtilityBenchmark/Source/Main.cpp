@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    Benchmarks the Utility processor's processBlock() across parameter
+    combinations, block sizes and sample rates.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ProcessorBenchmark.h"
+
+
+static const char* const usage =
+    "UtilityBenchmark [options]\n"
+    "\n"
+    "  --cases=<name,...>            cases to run, all by default (see --list-cases)\n"
+    "  --block-sizes=<n,...>         16,32,64,128,256,512,1024,2048,4096 by default\n"
+    "  --sample-rates=<hz,...>       44100,48000,96000,192000 by default\n"
+    "  --tile-sizes=<n,...>          processing tile sizes, powers of two from 16 to\n"
+    "                                1024, the plugin's default by default\n"
+    "  --precision=float|double|both float by default\n"
+    "  --seconds=<s>                 time spent on each measurement, 0.25 by default\n"
+    "  --json=<file>                 writes the results as JSON\n"
+    "  --csv=<file>                  writes the results as CSV\n"
+    "  --baseline=<file>             compares with the JSON of an earlier run and fails\n"
+    "                                if a median got slower by more than the threshold\n"
+    "  --threshold=<percent>         allowed slowdown against the baseline, 10 by default\n"
+    "  --list-cases                  prints the cases and their parameters";
+
+static juce::StringArray getListOption(juce::ArgumentList& args, const juce::String& option, const juce::String& defaultValue)
+{
+    auto value = args.removeValueForOption(option);
+    return juce::StringArray::fromTokens(value.isEmpty() ? defaultValue : value, ",", {});
+}
+
+static void listCases(const juce::ArgumentList&)
+{
+    for (const auto& benchmarkCase : ProcessorBenchmark::getCases())
+    {
+        juce::StringArray parameters;
+
+        for (const auto& [id, text] : benchmarkCase.parameters)
+            parameters.add(id + "=" + text);
+
+        std::cout << benchmarkCase.name.paddedRight(' ', 20) << parameters.joinIntoString(" ") << std::endl;
+    }
+}
+
+static juce::String toCsv(const juce::Array<BenchmarkResult>& results)
+{
+    juce::String csv = "case,sampleRate,blockSize,tileSize,precision,nsPerSampleMedian,nsPerSampleMean,nsPerSampleStdDev,nsPerSampleMin,realtimeFactor,passes\n";
+
+    for (const auto& result : results)
+        csv << result.caseName << "," << result.sampleRate << "," << result.blockSize << "," << result.tileSize << ","
+            << (result.doublePrecision ? "double" : "float") << "," << result.median << "," << result.mean << ","
+            << result.standardDeviation << "," << result.minimum << "," << result.getRealtimeFactor() << ","
+            << result.numPasses << "\n";
+
+    return csv;
+}
+
+// Prints the changes against the baseline, returns the number of regressions
+static int compareWithBaseline(const juce::Array<BenchmarkResult>& results, const juce::File& file, double thresholdPercent)
+{
+    const auto json = juce::JSON::parse(file);
+
+    if (!json.isArray())
+        juce::ConsoleApplication::fail("Can't read the baseline " + file.getFullPathName());
+
+    std::map<juce::String, BenchmarkResult> baseline;
+
+    for (const auto& value : *json.getArray())
+    {
+        const auto result = BenchmarkResult::fromVar(value);
+        baseline[result.getKey()] = result;
+    }
+
+    auto numRegressions = 0;
+
+    for (const auto& result : results)
+    {
+        const auto found = baseline.find(result.getKey());
+
+        if (found == baseline.end())
+            continue;
+
+        const auto change = (result.median / found->second.median - 1.0) * 100.0;
+
+        if (change > thresholdPercent)
+        {
+            std::cout << "SLOWER " << result.getKey() << ": " << juce::String(found->second.median, 3) << " -> "
+                      << juce::String(result.median, 3) << " ns/sample (+" << juce::String(change, 1) << "%)" << std::endl;
+            ++numRegressions;
+        }
+    }
+
+    return numRegressions;
+}
+
+static void runBenchmarks(const juce::ArgumentList& arguments)
+{
+    auto args = arguments;
+
+    const auto caseNames = getListOption(args, "--cases", {});
+    const auto blockSizes = getListOption(args, "--block-sizes", "16,32,64,128,256,512,1024,2048,4096");
+    const auto sampleRates = getListOption(args, "--sample-rates", "44100,48000,96000,192000");
+    const auto tileSizes = getListOption(args, "--tile-sizes", juce::String(UTILITY_TILE_SIZE));
+    const auto precision = args.removeValueForOption("--precision").toLowerCase();
+    const auto secondsOption = args.removeValueForOption("--seconds");
+    const auto jsonFile = args.containsOption("--json") ? args.getFileForOption("--json") : juce::File();
+    args.removeValueForOption("--json");
+    const auto csvFile = args.containsOption("--csv") ? args.getFileForOption("--csv") : juce::File();
+    args.removeValueForOption("--csv");
+    const auto baselineFile = args.containsOption("--baseline") ? args.getExistingFileForOption("--baseline") : juce::File();
+    args.removeValueForOption("--baseline");
+    const auto thresholdOption = args.removeValueForOption("--threshold");
+
+    if (args.size() > 0)
+        juce::ConsoleApplication::fail("Unknown argument " + args.arguments.getReference(0).text);
+
+    std::vector<BenchmarkCase> cases;
+
+    for (const auto& benchmarkCase : ProcessorBenchmark::getCases())
+        if (caseNames.isEmpty() || caseNames.contains(benchmarkCase.name))
+            cases.push_back(benchmarkCase);
+
+    if (cases.empty())
+        juce::ConsoleApplication::fail("No such case, see --list-cases");
+
+    juce::Array<bool> precisions;
+
+    if (precision.isEmpty() || precision == "float" || precision == "both")
+        precisions.add(false);
+
+    if (precision == "double" || precision == "both")
+        precisions.add(true);
+
+    if (precisions.isEmpty())
+        juce::ConsoleApplication::fail("Unknown precision " + precision);
+
+    for (const auto& tileSize : tileSizes)
+    {
+        const auto size = tileSize.getIntValue();
+
+        if (!juce::isPowerOfTwo(size) || size < UtilityAudioProcessor::minimumTileSize || size > UtilityAudioProcessor::maximumTileSize)
+            juce::ConsoleApplication::fail("Tile sizes must be powers of two from 16 to 1024");
+    }
+
+    ProcessorBenchmark benchmark(secondsOption.isEmpty() ? 0.25 : secondsOption.getDoubleValue());
+    juce::Array<BenchmarkResult> results;
+
+    std::cout << juce::String("case").paddedRight(' ', 20) << juce::String("rate").paddedLeft(' ', 8)
+              << juce::String("block").paddedLeft(' ', 7) << juce::String("tile").paddedLeft(' ', 6) << juce::String("precision").paddedLeft(' ', 10)
+              << juce::String("ns/sample").paddedLeft(' ', 11) << juce::String("+-").paddedLeft(' ', 8)
+              << juce::String("min").paddedLeft(' ', 9) << juce::String("x realtime").paddedLeft(' ', 12) << std::endl;
+
+    for (const auto& benchmarkCase : cases)
+    {
+        for (const auto& sampleRate : sampleRates)
+        {
+            for (const auto& blockSize : blockSizes)
+            {
+                for (const auto& tileSize : tileSizes)
+                {
+                    for (auto doublePrecision : precisions)
+                    {
+                        const auto result = benchmark.run(benchmarkCase, sampleRate.getDoubleValue(), blockSize.getIntValue(),
+                                                          tileSize.getIntValue(), doublePrecision);
+                        results.add(result);
+
+                        std::cout << result.caseName.paddedRight(' ', 20) << juce::String(result.sampleRate, 0).paddedLeft(' ', 8)
+                                  << juce::String(result.blockSize).paddedLeft(' ', 7)
+                                  << juce::String(result.tileSize).paddedLeft(' ', 6)
+                                  << juce::String(doublePrecision ? "double" : "float").paddedLeft(' ', 10)
+                                  << juce::String(result.median, 3).paddedLeft(' ', 11)
+                                  << juce::String(result.standardDeviation, 3).paddedLeft(' ', 8)
+                                  << juce::String(result.minimum, 3).paddedLeft(' ', 9)
+                                  << juce::String(result.getRealtimeFactor(), 0).paddedLeft(' ', 12) << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    if (jsonFile != juce::File())
+    {
+        juce::Array<juce::var> values;
+
+        for (const auto& result : results)
+            values.add(result.toVar());
+
+        if (!jsonFile.replaceWithText(juce::JSON::toString(juce::var(values))))
+            juce::ConsoleApplication::fail("Can't write " + jsonFile.getFullPathName());
+    }
+
+    if (csvFile != juce::File() && !csvFile.replaceWithText(toCsv(results)))
+        juce::ConsoleApplication::fail("Can't write " + csvFile.getFullPathName());
+
+    if (baselineFile != juce::File())
+    {
+        const auto threshold = thresholdOption.isEmpty() ? 10.0 : thresholdOption.getDoubleValue();
+        const auto numRegressions = compareWithBaseline(results, baselineFile, threshold);
+
+        if (numRegressions > 0)
+            juce::ConsoleApplication::fail(juce::String(numRegressions) + " measurements got slower than the baseline");
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // The parameters and their value tree expect a message manager, although
+    // no message loop ever runs
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", usage, false);
+    app.addCommand({ "--list-cases", "--list-cases", "Prints the cases and their parameters", {}, listCases });
+    app.addDefaultCommand({ {}, "[options]", "Runs the benchmarks", usage, runBenchmarks });
+
+    return app.findAndRunCommand(argc, argv);
+}
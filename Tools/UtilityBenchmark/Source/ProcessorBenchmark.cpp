@@ -0,0 +1,173 @@
+#include "ProcessorBenchmark.h"
+
+
+juce::String BenchmarkResult::getKey() const
+{
+    return caseName + "/" + juce::String(sampleRate, 0) + "/" + juce::String(blockSize) + "/tile" + juce::String(tileSize)
+         + (doublePrecision ? "/double" : "/float");
+}
+
+juce::var BenchmarkResult::toVar() const
+{
+    auto* object = new juce::DynamicObject();
+    object->setProperty("case", caseName);
+    object->setProperty("sampleRate", sampleRate);
+    object->setProperty("blockSize", blockSize);
+    object->setProperty("tileSize", tileSize);
+    object->setProperty("precision", doublePrecision ? "double" : "float");
+    object->setProperty("nsPerSampleMedian", median);
+    object->setProperty("nsPerSampleMean", mean);
+    object->setProperty("nsPerSampleStdDev", standardDeviation);
+    object->setProperty("nsPerSampleMin", minimum);
+    object->setProperty("realtimeFactor", getRealtimeFactor());
+    object->setProperty("passes", numPasses);
+    return juce::var(object);
+}
+
+BenchmarkResult BenchmarkResult::fromVar(const juce::var& value)
+{
+    BenchmarkResult result;
+    result.caseName = value["case"].toString();
+    result.sampleRate = value["sampleRate"];
+    result.blockSize = value["blockSize"];
+    // Results from before the tile size was a dimension used the default
+    result.tileSize = value.getProperty("tileSize", UTILITY_TILE_SIZE);
+    result.doublePrecision = value["precision"].toString() == "double";
+    result.median = value["nsPerSampleMedian"];
+    result.mean = value["nsPerSampleMean"];
+    result.standardDeviation = value["nsPerSampleStdDev"];
+    result.minimum = value["nsPerSampleMin"];
+    result.numPasses = value["passes"];
+    return result;
+}
+
+//==============================================================================
+const std::vector<BenchmarkCase>& ProcessorBenchmark::getCases()
+{
+    static const std::vector<BenchmarkCase> cases{
+        { "bypass", {} },
+        { "gain", { { "Gain", "-6" } } },
+        { "width", { { "Width", "150" } } },
+        { "mid-side", { { "MidSideMode", "1" }, { "MidSide", "30" } } },
+        { "mode", { { "Mode", "Swap" } } },
+        { "polarity", { { "InvertPhaseLeft", "1" } } },
+        { "mono", { { "Mono", "1" } } },
+        { "gain-balance", { { "Gain", "-6" }, { "Balance", "20" } } },
+        { "bass-mono", { { "BassMono", "1" } } },
+        { "bass-mono-side", { { "BassMono", "1" }, { "BassMonoMode", "Side" } } },
+        { "bass-mono-linear", { { "BassMono", "1" }, { "BassMonoMode", "Linear Phase" } } },
+        { "dc", { { "DC", "1" } } },
+        { "mute", { { "Mute", "1" } } },
+        { "all", { { "Width", "150" }, { "InvertPhaseLeft", "1" }, { "Gain", "-3" }, { "Balance", "10" },
+                   { "BassMono", "1" }, { "DC", "1" } } },
+    };
+
+    return cases;
+}
+
+ProcessorBenchmark::ProcessorBenchmark(double seconds)
+    : secondsPerMeasurement(seconds), source(2, passLength)
+{
+    // Noise at -12 dBFS, the same for every run
+    juce::Random random(1);
+
+    for (int channel = 0; channel < source.getNumChannels(); ++channel)
+        for (int sample = 0; sample < passLength; ++sample)
+            source.setSample(channel, sample, (random.nextDouble() * 2.0 - 1.0) * 0.25);
+}
+
+BenchmarkResult ProcessorBenchmark::run(const BenchmarkCase& benchmarkCase, double sampleRate, int blockSize, int tileSize, bool doublePrecision)
+{
+    UtilityAudioProcessor processor;
+
+    for (const auto& [id, text] : benchmarkCase.parameters)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->getValueForText(text));
+    }
+
+    processor.setProcessingPrecision(doublePrecision ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+    processor.setTileSize(tileSize);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    BenchmarkResult result;
+    result.caseName = benchmarkCase.name;
+    result.sampleRate = sampleRate;
+    result.blockSize = blockSize;
+    result.tileSize = processor.getTileSize();
+    result.doublePrecision = doublePrecision;
+
+    if (doublePrecision)
+        measure<double>(processor, result);
+    else
+        measure<float>(processor, result);
+
+    processor.releaseResources();
+    return result;
+}
+
+template <typename SampleType>
+void ProcessorBenchmark::measure(UtilityAudioProcessor& processor, BenchmarkResult& result)
+{
+    const auto blockSize = result.blockSize;
+    juce::AudioBuffer<SampleType> buffer(2, passLength);
+    juce::MidiBuffer midi;
+
+    const auto process = [&]
+    {
+        for (int start = 0; start + blockSize <= passLength; start += blockSize)
+        {
+            juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), 2, start, blockSize);
+            processor.processBlock(block, midi);
+        }
+    };
+
+    // The linear phase filter's kernel arrives in the background
+    const auto deadline = juce::Time::getMillisecondCounter() + 10000;
+
+    while (!processor.isReadyToRender() && juce::Time::getMillisecondCounter() < deadline)
+    {
+        buffer.clear();
+        process();
+        juce::Thread::sleep(1);
+    }
+
+    // One untimed pass to warm up the caches and branch predictors
+    buffer.makeCopyOf(source, true);
+    process();
+
+    const auto numSamples = (double)(passLength / blockSize * blockSize);
+    const auto ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+    const auto endTime = juce::Time::getMillisecondCounterHiRes() + secondsPerMeasurement * 1000.0;
+
+    std::vector<double> nanosecondsPerSample;
+
+    // At least enough passes for the statistics to mean something
+    while (nanosecondsPerSample.size() < 20 || juce::Time::getMillisecondCounterHiRes() < endTime)
+    {
+        buffer.makeCopyOf(source, true);
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        process();
+        const auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+
+        nanosecondsPerSample.push_back((double)ticks / ticksPerSecond * 1.0e9 / numSamples);
+    }
+
+    const auto numPasses = nanosecondsPerSample.size();
+    std::sort(nanosecondsPerSample.begin(), nanosecondsPerSample.end());
+
+    const auto mean = std::accumulate(nanosecondsPerSample.begin(), nanosecondsPerSample.end(), 0.0) / (double)numPasses;
+    auto sumOfSquares = 0.0;
+
+    for (auto value : nanosecondsPerSample)
+        sumOfSquares += (value - mean) * (value - mean);
+
+    result.median = nanosecondsPerSample[numPasses / 2];
+    result.mean = mean;
+    result.standardDeviation = std::sqrt(sumOfSquares / (double)(numPasses - 1));
+    result.minimum = nanosecondsPerSample.front();
+    result.numPasses = (int)numPasses;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+
+// A set of parameter values to benchmark, as (parameter ID, value text) pairs
+// applied to a default processor
+struct BenchmarkCase
+{
+    juce::String name;
+    std::vector<std::pair<juce::String, juce::String>> parameters;
+};
+
+struct BenchmarkResult
+{
+    juce::String caseName;
+    double sampleRate = 0;
+    int blockSize = 0;
+    int tileSize = UTILITY_TILE_SIZE;
+    bool doublePrecision = false;
+
+    // Nanoseconds per stereo sample frame over the timed passes
+    double median = 0, mean = 0, standardDeviation = 0, minimum = 0;
+    int numPasses = 0;
+
+    // How many times faster than real time the median is
+    double getRealtimeFactor() const { return 1.0e9 / (median * sampleRate); }
+
+    // Identifies the same measurement in another run
+    juce::String getKey() const;
+
+    juce::var toVar() const;
+    static BenchmarkResult fromVar(const juce::var& value);
+};
+
+// Times UtilityAudioProcessor::processBlock() on stereo noise. Every
+// measurement gets a freshly prepared processor. A pass processes a buffer of
+// passLength samples block by block, the way a host would, and is timed as a
+// whole so the timer's own cost stays out of small blocks; the buffer is
+// refilled from the source between passes, outside the timing. Passes repeat
+// until the time per measurement has been used up.
+class ProcessorBenchmark
+{
+public:
+    // The meaningful parameter combinations, each stage on its own and all together
+    static const std::vector<BenchmarkCase>& getCases();
+
+    explicit ProcessorBenchmark(double secondsPerMeasurement);
+
+    // See UtilityAudioProcessor::setTileSize() for the tile size
+    BenchmarkResult run(const BenchmarkCase& benchmarkCase, double sampleRate, int blockSize, int tileSize, bool doublePrecision);
+
+private:
+    template <typename SampleType>
+    void measure(UtilityAudioProcessor& processor, BenchmarkResult& result);
+
+    // Small enough to stay in the L2 cache between passes, as a host's buffers would
+    static constexpr int passLength = 16384;
+
+    const double secondsPerMeasurement;
+    juce::AudioBuffer<double> source;
+};
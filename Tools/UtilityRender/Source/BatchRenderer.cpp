@@ -0,0 +1,477 @@
+#include "BatchRenderer.h"
+
+
+// Same layouts as UtilityAudioProcessor::isBusesLayoutSupported(), by channel count
+static juce::AudioChannelSet layoutForChannels(int numChannels)
+{
+    switch (numChannels)
+    {
+        case 1:  return juce::AudioChannelSet::mono();
+        case 2:  return juce::AudioChannelSet::stereo();
+        case 4:  return juce::AudioChannelSet::quadraphonic();
+        case 6:  return juce::AudioChannelSet::create5point1();
+        case 8:  return juce::AudioChannelSet::create7point1();
+        case 12: return juce::AudioChannelSet::create7point1point4();
+        default: return {};
+    }
+}
+
+//==============================================================================
+// Pulls files off the shared list until it is empty, with its own processor
+class BatchRenderer::Worker : public juce::ThreadPoolJob
+{
+public:
+    Worker(BatchRenderer& renderer, UtilityAudioProcessor& processor, const juce::Array<juce::File>& inputs,
+           std::atomic<int>& nextInput, std::atomic<int>& numFailed)
+        : juce::ThreadPoolJob("Render"), renderer(renderer), processor(processor), inputs(inputs),
+          nextInput(nextInput), numFailed(numFailed)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        for (auto index = nextInput++; index < inputs.size() && !shouldExit(); index = nextInput++)
+        {
+            const auto& input = inputs.getReference(index);
+            juce::String error;
+
+            if (!renderer.renderFile(processor, input, error))
+            {
+                renderer.report(input.getFileName() + ": " + error);
+                ++numFailed;
+            }
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    BatchRenderer& renderer;
+    UtilityAudioProcessor& processor;
+    const juce::Array<juce::File>& inputs;
+    std::atomic<int>& nextInput;
+    std::atomic<int>& numFailed;
+};
+
+//==============================================================================
+// A file split into chunks: workers render the chunks in order while the
+// calling thread writes them out in order
+struct BatchRenderer::ChunkedFile
+{
+    struct Chunk
+    {
+        juce::AudioBuffer<float> output;
+        juce::WaitableEvent finished;
+        juce::String error;
+    };
+
+    juce::File input;
+    juce::int64 length = 0;
+    juce::int64 chunkLength = 0;
+    juce::int64 warmUp = 0;
+
+    // Rendered chunks wait for the writer in memory, at most this many ahead of it
+    int maximumChunksAhead = 0;
+
+    juce::OwnedArray<Chunk> chunks;
+    std::atomic<int> nextChunk{ 0 };
+    std::atomic<int> numWritten{ 0 };
+    std::atomic<bool> cancelled{ false };
+    juce::WaitableEvent chunkWritten;
+};
+
+class BatchRenderer::ChunkWorker : public juce::ThreadPoolJob
+{
+public:
+    ChunkWorker(BatchRenderer& renderer, UtilityAudioProcessor& processor, ChunkedFile& file)
+        : juce::ThreadPoolJob("Render Chunks"), renderer(renderer), processor(processor), file(file)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        // A reader per worker, mapping the same file is cheap
+        auto reader = renderer.createReader(file.input);
+
+        for (auto index = file.nextChunk++; index < file.chunks.size(); index = file.nextChunk++)
+        {
+            while (index >= file.numWritten.load() + file.maximumChunksAhead && !file.cancelled.load())
+                file.chunkWritten.wait(20);
+
+            if (file.cancelled.load())
+                break;
+
+            auto& chunk = *file.chunks.getUnchecked(index);
+            const auto start = (juce::int64)index * file.chunkLength;
+            const auto end = juce::jmin(start + file.chunkLength, file.length);
+            auto numRendered = 0;
+
+            const auto copy = [&](const float* const* channels, int numSamples)
+            {
+                for (int channel = 0; channel < chunk.output.getNumChannels(); ++channel)
+                    chunk.output.copyFrom(channel, numRendered, channels[channel], numSamples);
+
+                numRendered += numSamples;
+            };
+
+            // Every chunk starts from a freshly prepared processor, like the whole file would
+            if (reader == nullptr)
+                chunk.error = "can't read this file";
+            else if (renderer.prepare(processor, *reader, chunk.error))
+            {
+                chunk.output.setSize((int)reader->numChannels, (int)(end - start));
+                renderer.process(processor, *reader, start, end, file.warmUp, copy, chunk.error);
+            }
+
+            chunk.finished.signal();
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    BatchRenderer& renderer;
+    UtilityAudioProcessor& processor;
+    ChunkedFile& file;
+};
+
+//==============================================================================
+BatchRenderer::BatchRenderer(RenderSettings newSettings)
+    : settings(std::move(newSettings))
+{
+    formatManager.registerBasicFormats();
+    writerThread.startThread();
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    writerThread.stopThread(5000);
+}
+
+int BatchRenderer::render(const juce::Array<juce::File>& inputs)
+{
+    const auto chunked = settings.chunkSeconds > 0;
+    const auto numJobs = chunked ? juce::jmax(1, settings.numJobs) : juce::jlimit(1, juce::jmax(1, inputs.size()), settings.numJobs);
+
+    // The processors are created and given their state here rather than on
+    // the workers, so parameter set-up stays on the thread that owns the
+    // message manager
+    juce::OwnedArray<UtilityAudioProcessor> processors;
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        auto* processor = processors.add(new UtilityAudioProcessor());
+        processor->setNonRealtime(true);
+        processor->setStateInformation(settings.state.getData(), (int)settings.state.getSize());
+    }
+
+    juce::ThreadPool pool(numJobs);
+
+    if (chunked)
+    {
+        auto numFailed = 0;
+
+        for (const auto& input : inputs)
+        {
+            juce::String error;
+
+            if (!renderFileInChunks(pool, processors, input, error))
+            {
+                report(input.getFileName() + ": " + error);
+                ++numFailed;
+            }
+        }
+
+        return numFailed;
+    }
+
+    std::atomic<int> nextInput{ 0 };
+    std::atomic<int> numFailed{ 0 };
+    juce::OwnedArray<Worker> workers;
+
+    for (auto* processor : processors)
+        pool.addJob(workers.add(new Worker(*this, *processor, inputs, nextInput, numFailed)), false);
+
+    for (auto* worker : workers)
+        pool.waitForJobToFinish(worker, -1);
+
+    return numFailed.load();
+}
+
+bool BatchRenderer::renderFile(UtilityAudioProcessor& processor, const juce::File& input, juce::String& error)
+{
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    auto reader = createReader(input);
+
+    if (reader == nullptr)
+    {
+        error = "can't read this file";
+        return false;
+    }
+
+    if (!prepare(processor, *reader, error))
+        return false;
+
+    auto writer = createWriter(input, *reader, error);
+
+    if (writer == nullptr)
+        return false;
+
+    juce::AudioFormatWriter::ThreadedWriter threadedWriter(writer.release(), writerThread, 8 * settings.blockSize);
+
+    const auto write = [&](const float* const* channels, int numSamples)
+    {
+        // The writer's FIFO is full when the disk falls behind
+        while (!threadedWriter.write(channels, numSamples))
+            juce::Thread::sleep(1);
+    };
+
+    if (!process(processor, *reader, 0, reader->lengthInSamples, 0, write, error))
+        return false;
+
+    report(input, reader->lengthInSamples, reader->sampleRate, startTime);
+    return true;
+}
+
+bool BatchRenderer::renderFileInChunks(juce::ThreadPool& pool, const juce::OwnedArray<UtilityAudioProcessor>& processors,
+                                       const juce::File& input, juce::String& error)
+{
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    auto reader = createReader(input);
+
+    if (reader == nullptr)
+    {
+        error = "can't read this file";
+        return false;
+    }
+
+    auto writer = createWriter(input, *reader, error);
+
+    if (writer == nullptr)
+        return false;
+
+    // Chunks and their warm-up start on multiples of the block size, so every
+    // block lines up with the same block of a sequential render
+    const auto blockSize = (juce::int64)settings.blockSize;
+    const auto roundUp = [blockSize](juce::int64 samples) { return (samples + blockSize - 1) / blockSize * blockSize; };
+
+    auto& firstProcessor = *processors.getFirst();
+    firstProcessor.setRateAndBufferSizeDetails(reader->sampleRate, settings.blockSize);
+
+    ChunkedFile file;
+    file.input = input;
+    file.length = reader->lengthInSamples;
+    file.chunkLength = juce::jmax(blockSize, roundUp((juce::int64)(settings.chunkSeconds * reader->sampleRate)));
+    file.warmUp = roundUp(firstProcessor.getWarmUpSamples());
+    file.maximumChunksAhead = 2 * processors.size();
+
+    const auto numChunks = (int)juce::jmax((juce::int64)1, (file.length + file.chunkLength - 1) / file.chunkLength);
+
+    for (int i = 0; i < numChunks; ++i)
+        file.chunks.add(new ChunkedFile::Chunk());
+
+    juce::OwnedArray<ChunkWorker> workers;
+
+    for (int i = 0; i < juce::jmin(processors.size(), numChunks); ++i)
+        pool.addJob(workers.add(new ChunkWorker(*this, *processors.getUnchecked(i), file)), false);
+
+    for (auto* chunk : file.chunks)
+    {
+        chunk->finished.wait();
+
+        if (chunk->error.isNotEmpty())
+        {
+            error = chunk->error;
+            break;
+        }
+
+        if (!writer->writeFromAudioSampleBuffer(chunk->output, 0, chunk->output.getNumSamples()))
+        {
+            error = "write error";
+            break;
+        }
+
+        chunk->output.setSize(0, 0);
+        ++file.numWritten;
+        file.chunkWritten.signal();
+    }
+
+    file.cancelled = error.isNotEmpty();
+
+    for (auto* worker : workers)
+        pool.waitForJobToFinish(worker, -1);
+
+    if (error.isNotEmpty())
+        return false;
+
+    report(input, file.length, reader->sampleRate, startTime,
+           juce::String(numChunks) + " chunks, " + juce::String((double)file.warmUp / reader->sampleRate, 2) + " s warm-up");
+    return true;
+}
+
+bool BatchRenderer::prepare(UtilityAudioProcessor& processor, const juce::AudioFormatReader& reader, juce::String& error)
+{
+    const auto numChannels = (int)reader.numChannels;
+    const auto layout = layoutForChannels(numChannels);
+
+    juce::AudioProcessor::BusesLayout buses;
+    buses.inputBuses.add(layout);
+    buses.outputBuses.add(layout);
+
+    if (layout.isDisabled() || !processor.setBusesLayout(buses))
+    {
+        error = "unsupported channel count " + juce::String(numChannels);
+        return false;
+    }
+
+    const auto blockSize = settings.blockSize;
+    processor.setRateAndBufferSizeDetails(reader.sampleRate, blockSize);
+    processor.prepareToPlay(reader.sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    // The linear phase filter's kernel is designed in the background after
+    // prepareToPlay(). Silence leaves every other stage as it was prepared.
+    const auto deadline = juce::Time::getMillisecondCounter() + 10000;
+
+    while (!processor.isReadyToRender())
+    {
+        if (juce::Time::getMillisecondCounter() > deadline)
+        {
+            error = "timed out waiting for the linear phase filter";
+            return false;
+        }
+
+        buffer.clear();
+        processor.processBlock(buffer, midi);
+        juce::Thread::sleep(1);
+    }
+
+    return true;
+}
+
+template <typename WriteFunction>
+bool BatchRenderer::process(UtilityAudioProcessor& processor, juce::AudioFormatReader& reader, juce::int64 start, juce::int64 end,
+                            juce::int64 warmUp, WriteFunction&& write, juce::String& error)
+{
+    const auto numChannels = (int)reader.numChannels;
+    const auto blockSize = settings.blockSize;
+    const auto length = reader.lengthInSamples;
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    juce::HeapBlock<const float*> channels((size_t)numChannels);
+
+    // The first output sample of each block belongs to the input sample
+    // latency samples earlier. Silence is fed past the end of the file, so the
+    // output has the same length as the input.
+    auto readPosition = juce::jmax((juce::int64)0, start - warmUp);
+    auto outputPosition = readPosition - processor.getLatencySamples();
+
+    while (outputPosition < end)
+    {
+        const auto numToRead = (int)juce::jlimit((juce::int64)0, (juce::int64)blockSize, length - readPosition);
+
+        buffer.clear();
+
+        if (numToRead > 0 && !reader.read(&buffer, 0, numToRead, readPosition, true, true))
+        {
+            error = "read error at sample " + juce::String(readPosition);
+            return false;
+        }
+
+        processor.processBlock(buffer, midi);
+
+        // Only the part of the block that falls into [start, end)
+        const auto first = juce::jmax(start, outputPosition);
+        const auto last = juce::jmin(end, outputPosition + blockSize);
+
+        if (last > first)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                channels[channel] = buffer.getReadPointer(channel, (int)(first - outputPosition));
+
+            write(channels.get(), (int)(last - first));
+        }
+
+        readPosition += blockSize;
+        outputPosition += blockSize;
+    }
+
+    return true;
+}
+
+std::unique_ptr<juce::AudioFormatReader> BatchRenderer::createReader(const juce::File& file)
+{
+    auto* format = formatManager.findFormatForFileExtension(file.getFileExtension());
+
+    if (format == nullptr)
+        return {};
+
+    // Formats that can't be mapped (compressed ones like FLAC) are streamed
+    if (std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped{ format->createMemoryMappedReader(file) })
+        if (mapped->mapEntireFile())
+            return mapped;
+
+    if (auto stream = file.createInputStream())
+        return std::unique_ptr<juce::AudioFormatReader>(format->createReaderFor(stream.release(), true));
+
+    return {};
+}
+
+std::unique_ptr<juce::AudioFormatWriter> BatchRenderer::createWriter(const juce::File& input, const juce::AudioFormatReader& reader, juce::String& error)
+{
+    auto* format = formatManager.findFormatForName(settings.formatName);
+    jassert(format != nullptr);
+
+    const auto extension = format->getFileExtensions()[0];
+    const auto output = settings.outputDirectory.getChildFile(input.getFileNameWithoutExtension() + extension);
+
+    if (output == input)
+    {
+        error = "would overwrite the input";
+        return {};
+    }
+
+    output.deleteFile();
+    auto stream = output.createOutputStream();
+
+    if (stream == nullptr)
+    {
+        error = "can't create " + output.getFullPathName();
+        return {};
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), reader.sampleRate, reader.numChannels,
+                                                                            settings.bitDepth, reader.metadataValues, 0));
+
+    if (writer == nullptr)
+    {
+        error = format->getFormatName() + " can't write " + juce::String(reader.numChannels) + " channels at "
+              + juce::String(reader.sampleRate) + " Hz";
+        return {};
+    }
+
+    // The writer owns the stream now
+    stream.release();
+    return writer;
+}
+
+void BatchRenderer::report(const juce::File& input, juce::int64 length, double sampleRate, double startTime, const juce::String& details)
+{
+    const auto seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+    const auto audioSeconds = (double)length / sampleRate;
+
+    report(input.getFileName() + ": " + juce::String(audioSeconds, 1) + " s in " + juce::String(seconds, 2)
+           + " s (" + juce::String(audioSeconds / juce::jmax(seconds, 0.001), 0) + "x realtime"
+           + (details.isEmpty() ? juce::String(")") : ", " + details + ")"));
+}
+
+void BatchRenderer::report(const juce::String& line)
+{
+    const juce::ScopedLock lock(reportLock);
+    std::cout << line << std::endl;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+
+struct RenderSettings
+{
+    // State to render with, as written by UtilityAudioProcessor::getStateInformation()
+    juce::MemoryBlock state;
+
+    juce::File outputDirectory;
+    juce::String formatName;        // "WAV file", "FLAC file", ... as registered with the format manager
+    int bitDepth = 24;
+    int blockSize = 512;
+    int numJobs = 1;
+
+    // When above 0, every file is split into chunks of about this length that
+    // are rendered on all jobs at once, instead of a file per job
+    double chunkSeconds = 0;
+};
+
+// Renders audio files through the plugin without a host. Files are spread over
+// a pool of worker threads, each with its own processor instance, so each file
+// sees a freshly prepared processor and no two threads ever share one.
+//
+// Inputs are read through memory-mapped readers where the format has one (WAV,
+// AIFF), so the workers share the page cache instead of each buffering its own
+// copy. Outputs go through background writers on one shared thread, so disk
+// writes don't stall the processing.
+//
+// Long files can instead be split into chunks rendered in parallel. Each chunk
+// starts feeding input UtilityAudioProcessor::getWarmUpSamples() early, so
+// the filters are in the state they would have been in a render of the whole
+// file. The filters' start-up error is below -140 dB by then; the remaining
+// difference to a sequential render is float rounding, within 1e-6 (-120 dBFS).
+class BatchRenderer
+{
+public:
+    explicit BatchRenderer(RenderSettings settings);
+    ~BatchRenderer();
+
+    // Renders every file into the output directory, printing a line per file.
+    // Returns the number of files that failed.
+    int render(const juce::Array<juce::File>& inputs);
+
+    juce::AudioFormatManager& getFormatManager() { return formatManager; }
+
+private:
+    class Worker;
+    class ChunkWorker;
+    struct ChunkedFile;
+
+    // Renders one file on the calling thread, or returns false with an error message
+    bool renderFile(UtilityAudioProcessor& processor, const juce::File& input, juce::String& error);
+
+    // Renders one file on all the processors at once
+    bool renderFileInChunks(juce::ThreadPool& pool, const juce::OwnedArray<UtilityAudioProcessor>& processors,
+                            const juce::File& input, juce::String& error);
+
+    // Sets the processor up for the reader's format and waits until it can render
+    bool prepare(UtilityAudioProcessor& processor, const juce::AudioFormatReader& reader, juce::String& error);
+
+    // Renders the latency compensated output for samples [start, end) of the
+    // reader, feeding input from warmUp samples before start. Hands the output
+    // over in consecutive pieces to write(channels, numSamples).
+    template <typename WriteFunction>
+    bool process(UtilityAudioProcessor& processor, juce::AudioFormatReader& reader, juce::int64 start, juce::int64 end,
+                 juce::int64 warmUp, WriteFunction&& write, juce::String& error);
+
+    std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File& file);
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(const juce::File& file, const juce::AudioFormatReader& reader, juce::String& error);
+
+    void report(const juce::File& input, juce::int64 length, double sampleRate, double startTime, const juce::String& details = {});
+    void report(const juce::String& line);
+
+    const RenderSettings settings;
+    juce::AudioFormatManager formatManager;
+    juce::TimeSliceThread writerThread{ "Utility Render Writer" };
+
+    juce::CriticalSection reportLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BatchRenderer)
+};
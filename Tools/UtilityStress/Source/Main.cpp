@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    Stress test for the worst case time of the Utility processor's
+    processBlock() under random automation.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "StressTest.h"
+#include "../../../Source/AllocationGuard.h"
+
+static_assert(UTILITY_ALLOCATION_GUARD, "The stress test counts allocations, build it with UTILITY_ALLOCATION_GUARD=1");
+
+
+static const char* const usage =
+    "UtilityStress [options]\n"
+    "\n"
+    "  --blocks=<count>          blocks to process, 2000000 by default\n"
+    "  --sample-rate=<hz>        48000 by default\n"
+    "  --max-block-size=<n>      block sizes are random from 1 to this, 2048 by default\n"
+    "  --precision=float|double  float by default\n"
+    "  --automation=<p>          chance of parameter changes before a block, 0.05 by default\n"
+    "  --prepare-every=<blocks>  mean blocks between prepareToPlay() calls, 50000 by\n"
+    "                            default, 0 for only once\n"
+    "  --budget=<percent>        fails if a block takes longer than this share of its\n"
+    "                            duration, 100 by default\n"
+    "  --budget-us=<us>          fails if a block takes longer than this instead\n"
+    "  --seed=<n>                random seed, 1 by default\n"
+    "  --histogram=<file>        writes the block time histogram as CSV\n"
+    "\n"
+    "Fails if any block is over budget or allocates memory.";
+
+static juce::String formatMicroseconds(double nanoseconds)
+{
+    return juce::String(nanoseconds * 0.001, 2) + " us";
+}
+
+static void runStressTest(const juce::ArgumentList& arguments)
+{
+    auto args = arguments;
+    StressSettings settings;
+
+    const auto readOption = [&args](const juce::String& option, auto defaultValue)
+    {
+        const auto text = args.removeValueForOption(option);
+        return text.isEmpty() ? defaultValue : (decltype(defaultValue))text.getDoubleValue();
+    };
+
+    settings.numBlocks = readOption("--blocks", settings.numBlocks);
+    settings.sampleRate = readOption("--sample-rate", settings.sampleRate);
+    settings.maximumBlockSize = readOption("--max-block-size", settings.maximumBlockSize);
+    settings.automationProbability = readOption("--automation", settings.automationProbability);
+    settings.blocksPerPrepare = readOption("--prepare-every", settings.blocksPerPrepare);
+    settings.budgetPercent = readOption("--budget", settings.budgetPercent);
+    settings.budgetMicroseconds = readOption("--budget-us", settings.budgetMicroseconds);
+    settings.seed = readOption("--seed", settings.seed);
+
+    const auto precision = args.removeValueForOption("--precision").toLowerCase();
+    settings.doublePrecision = precision == "double";
+
+    if (precision.isNotEmpty() && precision != "float" && precision != "double")
+        juce::ConsoleApplication::fail("Unknown precision " + precision);
+
+    const auto histogramFile = args.containsOption("--histogram") ? args.getFileForOption("--histogram") : juce::File();
+    args.removeValueForOption("--histogram");
+
+    if (args.size() > 0)
+        juce::ConsoleApplication::fail("Unknown argument " + args.arguments.getReference(0).text);
+
+    if (settings.numBlocks <= 0 || settings.sampleRate <= 0 || settings.maximumBlockSize <= 0)
+        juce::ConsoleApplication::fail("Blocks, sample rate and block size must be positive");
+
+    std::cout << "Processing " << juce::String(settings.numBlocks) << " blocks of 1 to " << juce::String(settings.maximumBlockSize)
+              << " samples at " << juce::String(settings.sampleRate, 0) << " Hz..." << std::endl;
+
+    StressTest test(settings);
+    const auto report = test.run();
+    const auto& histogram = report.histogram;
+
+    std::cout << std::endl
+              << "mean    " << formatMicroseconds(histogram.getMean()) << std::endl
+              << "p50     " << formatMicroseconds(histogram.getPercentile(50)) << std::endl
+              << "p99     " << formatMicroseconds(histogram.getPercentile(99)) << std::endl
+              << "p99.9   " << formatMicroseconds(histogram.getPercentile(99.9)) << std::endl
+              << "p99.99  " << formatMicroseconds(histogram.getPercentile(99.99)) << std::endl
+              << "max     " << formatMicroseconds(histogram.getMaximum()) << std::endl
+              << "worst load " << juce::String(report.worstLoadPercent, 1) << "% of a block's duration" << std::endl
+              << "prepareToPlay() calls " << juce::String(report.numPrepares) << std::endl
+              << std::endl << "Slowest blocks:" << std::endl;
+
+    for (const auto& block : report.slowestBlocks)
+        std::cout << "  #" << juce::String(block.index) << ", " << juce::String(block.size) << " samples: "
+                  << formatMicroseconds(block.nanoseconds) << (block.afterPrepare ? ", first after prepare" : "")
+                  << (block.changes.isNotEmpty() ? ", " + block.changes : juce::String()) << std::endl;
+
+    if (histogramFile != juce::File() && !histogramFile.replaceWithText(histogram.toCsv()))
+        juce::ConsoleApplication::fail("Can't write " + histogramFile.getFullPathName());
+
+    std::cout << std::endl;
+
+    if (report.numAllocations > 0)
+        std::cout << juce::String(report.numAllocations) << " allocations in " << juce::String(report.numBlocksWithAllocations) << " blocks" << std::endl;
+
+    if (report.numOverBudget > 0)
+        std::cout << juce::String(report.numOverBudget) << " blocks over budget" << std::endl;
+
+    if (!report.passed())
+        juce::ConsoleApplication::fail("FAILED");
+
+    std::cout << "PASSED" << std::endl;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // The parameters and their value tree expect a message manager, although
+    // no message loop ever runs
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", usage, false);
+    app.addDefaultCommand({ {}, "[options]", "Runs the stress test", usage, runStressTest });
+
+    return app.findAndRunCommand(argc, argv);
+}
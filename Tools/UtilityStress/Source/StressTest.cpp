@@ -0,0 +1,188 @@
+#include "StressTest.h"
+#include "../../../Source/AllocationGuard.h"
+
+
+void LatencyHistogram::add(double nanoseconds)
+{
+    const auto bin = nanoseconds > 1.0 ? (int)(std::log2(nanoseconds) * binsPerOctave) : 0;
+    ++bins[(size_t)juce::jlimit(0, numBins - 1, bin)];
+
+    ++count;
+    sum += nanoseconds;
+    maximum = juce::jmax(maximum, nanoseconds);
+}
+
+double LatencyHistogram::getPercentile(double percent) const
+{
+    const auto target = (double)count * percent * 0.01;
+    juce::int64 below = 0;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        below += bins[(size_t)bin];
+
+        if ((double)below >= target && below > 0)
+            return juce::jmin(getUpperEdge(bin), maximum);
+    }
+
+    return maximum;
+}
+
+juce::String LatencyHistogram::toCsv() const
+{
+    juce::String csv = "fromNs,toNs,count\n";
+
+    for (int bin = 0; bin < numBins; ++bin)
+        if (bins[(size_t)bin] > 0)
+            csv << juce::String(bin > 0 ? getUpperEdge(bin - 1) : 0.0, 1) << "," << juce::String(getUpperEdge(bin), 1) << ","
+                << juce::String(bins[(size_t)bin]) << "\n";
+
+    return csv;
+}
+
+//==============================================================================
+StressTest::StressTest(StressSettings newSettings)
+    : settings(std::move(newSettings)), random(settings.seed)
+{
+}
+
+StressReport StressTest::run()
+{
+    UtilityAudioProcessor processor;
+    processor.setProcessingPrecision(settings.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                              : juce::AudioProcessor::singlePrecision);
+
+    StressReport report;
+    report.slowestBlocks.reserve(numSlowestBlocks + 1);
+
+    if (settings.doublePrecision)
+        run<double>(processor, report);
+    else
+        run<float>(processor, report);
+
+    return report;
+}
+
+template <typename SampleType>
+void StressTest::run(UtilityAudioProcessor& processor, StressReport& report)
+{
+    const auto maximumBlockSize = settings.maximumBlockSize;
+    const auto ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+
+    juce::Array<juce::RangedAudioParameter*> parameters;
+
+    for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            parameters.add(ranged);
+
+    // Input blocks are copied from random places in a second of noise
+    const auto sourceLength = juce::jmax(maximumBlockSize * 2, (int)settings.sampleRate);
+    juce::AudioBuffer<SampleType> source(2, sourceLength);
+
+    for (int channel = 0; channel < 2; ++channel)
+        for (int sample = 0; sample < sourceLength; ++sample)
+            source.setSample(channel, sample, (SampleType)((random.nextDouble() * 2.0 - 1.0) * 0.25));
+
+    juce::AudioBuffer<SampleType> buffer(2, maximumBlockSize);
+    juce::MidiBuffer midi;
+    std::array<Change, maximumChangesPerBlock> changes{};
+
+    auto prepared = false;
+
+    for (juce::int64 index = 0; index < settings.numBlocks; ++index)
+    {
+        // Like a host stopping and starting: the first blocks after a
+        // prepareToPlay() are where one-off work tends to hide
+        const auto afterPrepare = !prepared || (settings.blocksPerPrepare > 0 && random.nextDouble() * (double)settings.blocksPerPrepare < 1.0);
+
+        if (afterPrepare)
+        {
+            processor.setRateAndBufferSizeDetails(settings.sampleRate, maximumBlockSize);
+            processor.prepareToPlay(settings.sampleRate, maximumBlockSize);
+            prepared = true;
+            ++report.numPrepares;
+        }
+
+        const auto blockSize = 1 + random.nextInt(maximumBlockSize);
+        const auto sourceStart = random.nextInt(sourceLength - blockSize);
+
+        for (int channel = 0; channel < 2; ++channel)
+            buffer.copyFrom(channel, 0, source, channel, sourceStart, blockSize);
+
+        juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), 2, blockSize);
+
+        const auto numChanges = random.nextDouble() < settings.automationProbability ? pickChanges(parameters, changes) : 0;
+
+        // As the plugin wrappers apply automation: straight to the parameter,
+        // without notifying the host. Whatever that costs is the wrapper's.
+        for (int i = 0; i < numChanges; ++i)
+            changes[(size_t)i].parameter->setValue(changes[(size_t)i].value);
+
+        const auto allocationsBefore = ScopedAllocationGuard::getNumGuardedAllocations();
+        juce::int64 ticks;
+
+        {
+            ScopedAllocationGuard allocationGuard;
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            processor.processBlock(block, midi);
+            ticks = juce::Time::getHighResolutionTicks() - startTicks;
+        }
+
+        const auto numAllocations = ScopedAllocationGuard::getNumGuardedAllocations() - allocationsBefore;
+        const auto nanoseconds = (double)ticks / ticksPerSecond * 1.0e9;
+        const auto duration = (double)blockSize / settings.sampleRate * 1.0e9;
+        const auto budget = settings.budgetMicroseconds > 0 ? settings.budgetMicroseconds * 1000.0 : duration * settings.budgetPercent * 0.01;
+
+        report.histogram.add(nanoseconds);
+        report.worstLoadPercent = juce::jmax(report.worstLoadPercent, nanoseconds / duration * 100.0);
+
+        if (nanoseconds > budget)
+            ++report.numOverBudget;
+
+        if (numAllocations > 0)
+        {
+            report.numAllocations += numAllocations;
+            ++report.numBlocksWithAllocations;
+        }
+
+        auto& slowest = report.slowestBlocks;
+
+        if (slowest.size() < numSlowestBlocks || nanoseconds > slowest.back().nanoseconds)
+        {
+            const auto position = std::find_if(slowest.begin(), slowest.end(), [&](const auto& other) { return nanoseconds > other.nanoseconds; });
+            slowest.insert(position, { index, blockSize, nanoseconds, afterPrepare, describe(changes, numChanges) });
+
+            if (slowest.size() > numSlowestBlocks)
+                slowest.pop_back();
+        }
+    }
+}
+
+int StressTest::pickChanges(const juce::Array<juce::RangedAudioParameter*>& parameters, std::array<Change, maximumChangesPerBlock>& changes)
+{
+    const auto numChanges = 1 + random.nextInt(maximumChangesPerBlock);
+
+    for (int i = 0; i < numChanges; ++i)
+    {
+        auto* parameter = parameters[random.nextInt(parameters.size())];
+
+        // Switches flip, continuous parameters jump anywhere in their range
+        const auto value = parameter->getNumSteps() == 2 ? (parameter->getValue() < 0.5f ? 1.f : 0.f) : random.nextFloat();
+        changes[(size_t)i] = { parameter, value };
+    }
+
+    return numChanges;
+}
+
+juce::String StressTest::describe(const std::array<Change, maximumChangesPerBlock>& changes, int numChanges)
+{
+    juce::StringArray descriptions;
+
+    for (int i = 0; i < numChanges; ++i)
+    {
+        const auto& change = changes[(size_t)i];
+        descriptions.add(change.parameter->getParameterID() + "=" + change.parameter->getText(change.value, 32));
+    }
+
+    return descriptions.joinIntoString(", ");
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+
+// Block processing times in bins a 16th of an octave wide (4.4 %), from 1 ns
+// to about a second. Percentiles are read off as the upper edge of their bin.
+class LatencyHistogram
+{
+public:
+    void add(double nanoseconds);
+
+    juce::int64 getCount() const { return count; }
+    double getMean() const { return count > 0 ? sum / (double)count : 0.0; }
+    double getMaximum() const { return maximum; }
+    double getPercentile(double percent) const;
+
+    // One line per non-empty bin: lower edge, upper edge (ns), count
+    juce::String toCsv() const;
+
+private:
+    static constexpr int binsPerOctave = 16;
+    static constexpr int numBins = 30 * binsPerOctave;
+
+    static double getUpperEdge(int bin) { return std::exp2((double)(bin + 1) / binsPerOctave); }
+
+    std::array<juce::int64, numBins> bins{};
+    juce::int64 count = 0;
+    double sum = 0, maximum = 0;
+};
+
+struct StressSettings
+{
+    juce::int64 numBlocks = 2000000;
+    double sampleRate = 48000;
+    int maximumBlockSize = 2048;        // block sizes are random from 1 to this
+    bool doublePrecision = false;
+    juce::int64 seed = 1;
+
+    double automationProbability = 0.05;    // chance of a block starting with parameter changes
+    juce::int64 blocksPerPrepare = 50000;   // mean number of blocks between prepareToPlay() calls
+
+    // A block fails when it takes longer than this percentage of its own
+    // duration, or than the absolute budget if one is given
+    double budgetPercent = 100;
+    double budgetMicroseconds = 0;
+};
+
+struct StressReport
+{
+    struct Block
+    {
+        juce::int64 index;
+        int size;
+        double nanoseconds;
+        bool afterPrepare;
+        juce::String changes;
+    };
+
+    LatencyHistogram histogram;
+    double worstLoadPercent = 0;            // time over block duration
+    juce::int64 numOverBudget = 0;
+    juce::int64 numBlocksWithAllocations = 0;
+    int numAllocations = 0;
+    juce::int64 numPrepares = 0;
+    std::vector<Block> slowestBlocks;       // slowest first
+
+    bool passed() const { return numOverBudget == 0 && numAllocations == 0; }
+};
+
+// Runs processBlock() on noise for millions of blocks of random size, with
+// random parameter changes applied the way a host applies automation, right
+// before a block on the audio thread. Every processBlock() is timed on its own
+// and runs inside a ScopedAllocationGuard, so the tools must be built with
+// UTILITY_ALLOCATION_GUARD=1 for allocations to be counted; the guard's own
+// cost is only paid when something allocates.
+class StressTest
+{
+public:
+    explicit StressTest(StressSettings settings);
+
+    StressReport run();
+
+private:
+    static constexpr int maximumChangesPerBlock = 3;
+    static constexpr size_t numSlowestBlocks = 10;
+
+    struct Change
+    {
+        juce::RangedAudioParameter* parameter;
+        float value;
+    };
+
+    template <typename SampleType>
+    void run(UtilityAudioProcessor& processor, StressReport& report);
+
+    // Picks parameter changes for the next block, returns how many
+    int pickChanges(const juce::Array<juce::RangedAudioParameter*>& parameters, std::array<Change, maximumChangesPerBlock>& changes);
+    static juce::String describe(const std::array<Change, maximumChangesPerBlock>& changes, int numChanges);
+
+    const StressSettings settings;
+    juce::Random random;
+};
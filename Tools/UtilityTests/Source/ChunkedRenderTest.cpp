@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    BatchRenderer: a file rendered in chunks on several processors against
+    the same file rendered in one pass.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../UtilityRender/Source/BatchRenderer.h"
+
+
+// Each chunk warms the filters up from UtilityAudioProcessor::getWarmUpSamples()
+// of input before it, as the renderer documents; the settings with the
+// longest memory (DC blocking and each bass mono mode) must still match a
+// sequential render within 1e-6.
+class ChunkedRenderTest : public juce::UnitTest
+{
+public:
+    ChunkedRenderTest() : juce::UnitTest("Chunked rendering", "Utility") {}
+
+    void runTest() override
+    {
+        const auto directory = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                                   .getNonexistentChildFile("UtilityTests", {}, false);
+        directory.createDirectory();
+
+        const auto input = directory.getChildFile("noise.wav");
+        writeNoise(input);
+
+        for (const auto& mode : { "Crossover", "Side", "Linear Phase" })
+        {
+            beginTest(juce::String("DC blocking and bass mono, ") + mode);
+            compareRenders(input, directory, mode);
+        }
+
+        directory.deleteRecursively();
+    }
+
+private:
+    static constexpr double sampleRate = 48000;
+    static constexpr int lengthInSeconds = 10;
+
+    // Uncorrelated channels of white noise on a DC offset, as 32 bit float
+    static void writeNoise(const juce::File& file)
+    {
+        juce::Random random(1);
+        juce::AudioBuffer<float> noise(2, (int)sampleRate * lengthInSeconds);
+
+        for (int channel = 0; channel < noise.getNumChannels(); ++channel)
+            for (int i = 0; i < noise.getNumSamples(); ++i)
+                noise.setSample(channel, i, 0.1f + 0.5f * (2.f * random.nextFloat() - 1.f));
+
+        juce::WavAudioFormat format;
+        std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(file.createOutputStream().release(),
+                                                                               sampleRate, 2, 32, {}, 0));
+        writer->writeFromAudioSampleBuffer(noise, 0, noise.getNumSamples());
+    }
+
+    void compareRenders(const juce::File& input, const juce::File& directory, const juce::String& bassMonoMode)
+    {
+        RenderSettings settings;
+        settings.formatName = "WAV file";
+        settings.bitDepth = 32;
+        settings.numJobs = 4;
+
+        {
+            UtilityAudioProcessor processor;
+            setParameter(processor, "DC", "On");
+            setParameter(processor, "BassMono", "On");
+            setParameter(processor, "BassMonoMode", bassMonoMode);
+            processor.getStateInformation(settings.state);
+        }
+
+        const auto sequential = render(settings, input, directory.getChildFile("sequential"));
+
+        settings.chunkSeconds = 1;
+        const auto chunked = render(settings, input, directory.getChildFile("chunked"));
+
+        expect(sequential.getNumSamples() == (int)sampleRate * lengthInSeconds, "The sequential render is incomplete");
+        expect(chunked.getNumSamples() == sequential.getNumSamples(), "The renders differ in length");
+
+        if (chunked.getNumSamples() != sequential.getNumSamples())
+            return;
+
+        float maxDifference = 0;
+
+        for (int channel = 0; channel < sequential.getNumChannels(); ++channel)
+            for (int i = 0; i < sequential.getNumSamples(); ++i)
+                maxDifference = juce::jmax(maxDifference, std::abs(chunked.getSample(channel, i) - sequential.getSample(channel, i)));
+
+        logMessage("Largest difference: " + juce::String(maxDifference));
+        expect(maxDifference <= 1.0e-6f, "The chunked render differs from the sequential one by " + juce::String(maxDifference));
+    }
+
+    void setParameter(UtilityAudioProcessor& processor, const juce::String& id, const juce::String& text)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        expect(parameter != nullptr, "No parameter " + id);
+
+        if (parameter != nullptr)
+            parameter->setValueNotifyingHost(parameter->getValueForText(text));
+    }
+
+    // Renders the input into the directory and reads the result back
+    juce::AudioBuffer<float> render(const RenderSettings& settings, const juce::File& input, const juce::File& directory)
+    {
+        directory.createDirectory();
+
+        auto withDirectory = settings;
+        withDirectory.outputDirectory = directory;
+
+        BatchRenderer renderer(withDirectory);
+        expect(renderer.render({ input }) == 0, "Rendering failed");
+
+        juce::AudioBuffer<float> output;
+        std::unique_ptr<juce::AudioFormatReader> reader(renderer.getFormatManager().createReaderFor(directory.getChildFile(input.getFileName())));
+
+        if (reader != nullptr)
+        {
+            output.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
+            reader->read(&output, 0, output.getNumSamples(), 0, true, true);
+        }
+
+        return output;
+    }
+};
+
+static ChunkedRenderTest chunkedRenderTest;
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter: the EBU Tech 3341 and 3342 reference signals, which are
+    1 kHz stereo sines at given levels, at the usual sample rates.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/LoudnessMeter.h"
+
+
+class LoudnessMeterTest : public juce::UnitTest
+{
+public:
+    LoudnessMeterTest() : juce::UnitTest("LoudnessMeter", "Utility") {}
+
+    void runTest() override
+    {
+        for (auto sampleRate : { 44100.0, 48000.0, 96000.0 })
+        {
+            const auto rate = juce::String(sampleRate / 1000.0, 1) + " kHz";
+
+            beginTest("Momentary and short-term of a steady sine, " + rate);
+            testSteadySine(sampleRate, -23.f);
+            testSteadySine(sampleRate, -33.f);
+
+            // EBU Tech 3341 cases 3 and 4: the relative and absolute gates
+            beginTest("Integrated loudness, " + rate);
+            expectIntegrated(sampleRate, { { -36.f, 10 }, { -23.f, 60 }, { -36.f, 10 } }, -23.f);
+            expectIntegrated(sampleRate, { { -72.f, 10 }, { -36.f, 10 }, { -23.f, 60 }, { -36.f, 10 }, { -72.f, 10 } }, -23.f);
+
+            // EBU Tech 3342 cases 1 to 4
+            beginTest("Loudness range, " + rate);
+            expectRange(sampleRate, { { -20.f, 20 }, { -30.f, 20 } }, 10.f);
+            expectRange(sampleRate, { { -20.f, 20 }, { -15.f, 20 } }, 5.f);
+            expectRange(sampleRate, { { -40.f, 20 }, { -20.f, 20 } }, 20.f);
+            expectRange(sampleRate, { { -50.f, 20 }, { -35.f, 20 }, { -20.f, 20 }, { -35.f, 20 }, { -50.f, 20 } }, 15.f);
+        }
+    }
+
+private:
+    struct Segment
+    {
+        float level;    // dBFS of each channel's sine
+        int seconds;
+    };
+
+    // Feeds the meter as the processor does, in tiles
+    class SineSource
+    {
+    public:
+        explicit SineSource(double rate) : sampleRate(rate), tile(2, tileSize) {}
+
+        void feed(LoudnessMeter& meter, float level, double seconds)
+        {
+            const auto amplitude = juce::Decibels::decibelsToGain(level, -200.f);
+            const auto increment = juce::MathConstants<double>::twoPi * 1000.0 / sampleRate;
+            auto remaining = juce::roundToInt(seconds * sampleRate);
+
+            while (remaining > 0)
+            {
+                const auto numSamples = juce::jmin(remaining, tileSize);
+                tile.setSize(2, numSamples, false, false, true);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const auto sample = amplitude * (float)std::sin(phase);
+                    tile.setSample(0, i, sample);
+                    tile.setSample(1, i, sample);
+                    phase = std::fmod(phase + increment, juce::MathConstants<double>::twoPi);
+                }
+
+                meter.process(tile, 2);
+                remaining -= numSamples;
+            }
+        }
+
+    private:
+        static constexpr int tileSize = 512;
+
+        double sampleRate;
+        juce::AudioBuffer<float> tile;
+        double phase = 0;
+    };
+
+    void testSteadySine(double sampleRate, float level)
+    {
+        LoudnessMeter meter;
+        meter.prepare(sampleRate);
+        SineSource source(sampleRate);
+
+        // A full momentary window, then a full short-term one
+        source.feed(meter, level, 0.5);
+        expectWithinAbsoluteError(meter.getMomentaryLoudness(), level, 0.1f, "Momentary loudness");
+
+        source.feed(meter, level, 3.0);
+        expectWithinAbsoluteError(meter.getMomentaryLoudness(), level, 0.1f, "Momentary loudness");
+        expectWithinAbsoluteError(meter.getShortTermLoudness(), level, 0.1f, "Short-term loudness");
+        expectWithinAbsoluteError(meter.getIntegratedLoudness(), level, 0.1f, "Integrated loudness");
+    }
+
+    void measure(LoudnessMeter& meter, double sampleRate, std::initializer_list<Segment> segments)
+    {
+        meter.prepare(sampleRate);
+        SineSource source(sampleRate);
+
+        for (const auto& segment : segments)
+            source.feed(meter, segment.level, segment.seconds);
+    }
+
+    void expectIntegrated(double sampleRate, std::initializer_list<Segment> segments, float expected)
+    {
+        LoudnessMeter meter;
+        measure(meter, sampleRate, segments);
+        expectWithinAbsoluteError(meter.getIntegratedLoudness(), expected, 0.1f, "Integrated loudness");
+    }
+
+    void expectRange(double sampleRate, std::initializer_list<Segment> segments, float expected)
+    {
+        LoudnessMeter meter;
+        measure(meter, sampleRate, segments);
+        expectWithinAbsoluteError(meter.getLoudnessRange(), expected, 1.f, "Loudness range");
+    }
+};
+
+static LoudnessMeterTest loudnessMeterTest;
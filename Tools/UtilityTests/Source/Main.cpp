@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    Unit tests for the Utility plugin's DSP code. Returns a non-zero exit
+    code if any of them fails, for CI.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+
+int main()
+{
+    // The chunked render test needs the message manager for its processors
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("Utility");
+
+    int numFailures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult(i)->failures;
+
+    return numFailures > 0 ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    StereoKernels: the SIMD backends against the scalar reference.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/StereoKernels.h"
+
+
+static juce::String getBackendName(KernelBackend backend)
+{
+    switch (backend)
+    {
+    case KernelBackend::scalar: return "scalar";
+    case KernelBackend::sse2:   return "SSE2";
+    case KernelBackend::avx2:   return "AVX2";
+    case KernelBackend::avx512: return "AVX-512";
+    default:                    return {};
+    }
+}
+
+// Every vector backend this CPU supports against the scalar reference, within
+// the tolerance StereoKernels documents. Backends the CPU lacks are skipped,
+// so run it on machines with each instruction set.
+class StereoKernelsTest : public juce::UnitTest
+{
+public:
+    StereoKernelsTest() : juce::UnitTest("StereoKernels", "Utility") {}
+
+    void runTest() override
+    {
+        testBackends<float>("float");
+        testBackends<double>("double");
+    }
+
+private:
+    template <typename SampleType>
+    void testBackends(const juce::String& precision)
+    {
+        for (auto backend : { KernelBackend::sse2, KernelBackend::avx2, KernelBackend::avx512 })
+        {
+            if (!StereoKernels<SampleType>::isSupported(backend))
+            {
+                logMessage(getBackendName(backend) + " isn't supported by this CPU, skipped");
+                continue;
+            }
+
+            beginTest(getBackendName(backend) + " matches scalar, " + precision);
+            expect(StereoKernels<SampleType>::verifyBackend(backend, StereoKernels<SampleType>::defaultToleranceUlps),
+                   "More than " + juce::String(StereoKernels<SampleType>::defaultToleranceUlps) + " ulp from the scalar kernels");
+        }
+    }
+};
+
+static StereoKernelsTest stereoKernelsTest;
@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    TruePeakMeter: the inter-sample peak of a sine between its samples, and
+    the chunks it skips against interpolating every one of them.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/TruePeakMeter.h"
+
+
+class TruePeakMeterTest : public juce::UnitTest
+{
+public:
+    TruePeakMeterTest() : juce::UnitTest("TruePeakMeter", "Utility") {}
+
+    void runTest() override
+    {
+        beginTest("A sine at a quarter of the sample rate, 45 degrees off its samples");
+        testQuarterRateSine(1);
+        testQuarterRateSine(2);
+
+        beginTest("Skipped chunks never hide a peak");
+
+        for (int seed = 1; seed <= 20; ++seed)
+            testSkippedChunks(seed);
+    }
+
+private:
+    static constexpr int numPhases = TruePeakMeter::numPhases;
+    static constexpr int tapsPerPhase = TruePeakMeter::tapsPerPhase;
+    static constexpr int chunkSize = TruePeakMeter::chunkSize;
+
+    // Its samples are all ±0.707 of the amplitude, halfway between the sine's
+    // peaks: the true peak is 3 dB over the sample peak
+    void testQuarterRateSine(int numChannels)
+    {
+        constexpr float amplitude = 0.5f;
+        constexpr int numSamples = 4096;
+
+        juce::AudioBuffer<float> tile(numChannels, numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                tile.setSample(channel, i, amplitude * (float)std::sin(juce::MathConstants<double>::halfPi * i
+                                                                        + juce::MathConstants<double>::pi / 4));
+
+        TruePeakMeter meter;
+        meter.process(tile);
+
+        const auto samplePeak = juce::Decibels::gainToDecibels(tile.getMagnitude(0, 0, numSamples));
+
+        // Mono is measured as both channels
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            const auto truePeak = juce::Decibels::gainToDecibels(meter.getMaxTruePeak(channel));
+            expectWithinAbsoluteError(truePeak - samplePeak, 3.01f, 0.2f, "True peak over sample peak, dB");
+        }
+    }
+
+    // Random tiles of noise, sines, bursts and the interpolator's worst case
+    // (samples with the signs of a phase's coefficients), with levels around
+    // the held peak so that chunks are skipped by a narrow margin. After each
+    // tile the meter must agree with interpolating every complete chunk.
+    void testSkippedChunks(int seed)
+    {
+        juce::Random random(seed);
+        TruePeakMeter meter;
+
+        std::array<std::vector<float>, 2> signal;
+        std::array<float, 2> expectedPeak{};
+        int numMeasured = 0;
+
+        juce::AudioBuffer<float> tile(2, 1024);
+
+        for (int tileIndex = 0; tileIndex < 200; ++tileIndex)
+        {
+            const auto numSamples = random.nextInt({ 1, 1024 });
+            tile.setSize(2, numSamples, false, false, true);
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                const auto heldPeak = juce::jmax(expectedPeak[(size_t)channel], 0.01f);
+                generate(random, tile.getWritePointer(channel), numSamples, heldPeak);
+                signal[(size_t)channel].insert(signal[(size_t)channel].end(), tile.getReadPointer(channel), tile.getReadPointer(channel) + numSamples);
+            }
+
+            meter.process(tile);
+
+            // The meter measures whole chunks only
+            const auto numComplete = (int)signal[0].size() / chunkSize * chunkSize;
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                expectedPeak[(size_t)channel] = juce::jmax(expectedPeak[(size_t)channel],
+                                                           interpolatePeak(signal[(size_t)channel], numMeasured, numComplete));
+
+                const auto expected = expectedPeak[(size_t)channel];
+                expectWithinAbsoluteError(meter.getMaxTruePeak(channel), expected, expected * 1.0e-6f,
+                                          "True peak after tile " + juce::String(tileIndex) + ", seed " + juce::String(seed));
+            }
+
+            numMeasured = numComplete;
+        }
+    }
+
+    void generate(juce::Random& random, float* destination, int numSamples, float heldPeak)
+    {
+        const auto overshoot = TruePeakMeter::maximumOvershoot;
+
+        switch (random.nextInt(5))
+        {
+        case 0:
+            // Noise from well below to at the held peak
+            {
+                const auto level = heldPeak * (0.2f + 0.8f * random.nextFloat());
+
+                for (int i = 0; i < numSamples; ++i)
+                    destination[i] = level * (2.f * random.nextFloat() - 1.f);
+            }
+            break;
+
+        case 1:
+            // A sine of random frequency and phase, just under or over the held peak
+            {
+                const auto level = heldPeak * (0.9f + 0.15f * random.nextFloat());
+                const auto increment = juce::MathConstants<double>::pi * random.nextDouble();
+                const auto phase = juce::MathConstants<double>::twoPi * random.nextDouble();
+
+                for (int i = 0; i < numSamples; ++i)
+                    destination[i] = level * (float)std::sin(phase + increment * i);
+            }
+            break;
+
+        case 2:
+            // Silence with a single loud sample
+            std::fill(destination, destination + numSamples, 0.f);
+            destination[random.nextInt(numSamples)] = (random.nextBool() ? 1.f : -1.f) * heldPeak * (0.5f + 0.6f * random.nextFloat());
+            break;
+
+        default:
+            // The worst case of a random phase, whose sample peak times the
+            // overshoot lands within 1% of the held peak: skipped only if the
+            // bound holds
+            {
+                const auto& coefficients = TruePeakMeter::coefficients[random.nextInt(numPhases)];
+                const auto level = heldPeak / overshoot * (0.99f + 0.02f * random.nextFloat());
+                const auto end = random.nextInt(numSamples + tapsPerPhase);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const auto tap = end - i;
+                    destination[i] = tap >= 0 && tap < tapsPerPhase ? (coefficients[tap] < 0 ? -level : level)
+                                                                    : level * (2.f * random.nextFloat() - 1.f);
+                }
+            }
+            break;
+        }
+    }
+
+    // Highest interpolated value of samples [start, end), every phase of every sample
+    static float interpolatePeak(const std::vector<float>& signal, int start, int end)
+    {
+        float peak = 0;
+
+        for (int sample = start; sample < end; ++sample)
+        {
+            for (const auto& phase : TruePeakMeter::coefficients)
+            {
+                float value = 0;
+
+                for (int tap = 0; tap < tapsPerPhase; ++tap)
+                    if (sample - tap >= 0)
+                        value += phase[tap] * signal[(size_t)(sample - tap)];
+
+                peak = juce::jmax(peak, std::abs(value));
+            }
+        }
+
+        return peak;
+    }
+};
+
+static TruePeakMeterTest truePeakMeterTest;